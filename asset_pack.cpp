@@ -0,0 +1,184 @@
+#include "asset_pack.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// No raylib in this file, so the platform headers don't clash with its names
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+    #define ASSET_PACK_MAPPED
+#elif (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define ASSET_PACK_MAPPED
+#endif
+
+//----------------------------------------------------------------------------------
+// Pack state
+//----------------------------------------------------------------------------------
+static const unsigned char *packData = NULL;
+static size_t packSize = 0;
+static int entryCount = 0;
+static bool packMapped = false;     // Otherwise packData was malloc'd and read in one go
+#if defined(_WIN32)
+static HANDLE packMapping = NULL;
+#endif
+
+static uint32_t GetU32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static const unsigned char *GetEntry(int index)
+{
+    return packData + ASSET_PACK_HEADER_SIZE + (size_t)index * ASSET_PACK_ENTRY_SIZE;
+}
+
+static bool MapPackFile(const char *fileName)
+{
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    bool ok = GetFileSizeEx(file, &size) && (size.QuadPart > 0);
+    if (ok) packMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);      // The mapping keeps the file open
+    if (!ok || packMapping == NULL) return false;
+
+    packData = (const unsigned char *)MapViewOfFile(packMapping, FILE_MAP_READ, 0, 0, 0);
+    if (packData == NULL) {
+        CloseHandle(packMapping);
+        packMapping = NULL;
+        return false;
+    }
+    packSize = (size_t)size.QuadPart;
+    return true;
+#elif defined(ASSET_PACK_MAPPED)
+    int file = open(fileName, O_RDONLY);
+    if (file < 0) return false;
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+        data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file);            // The mapping keeps the file open
+    if (data == MAP_FAILED) return false;
+
+    packData = (const unsigned char *)data;
+    packSize = (size_t)info.st_size;
+    return true;
+#else
+    (void)fileName;
+    return false;
+#endif
+}
+
+static void UnmapPackFile(void)
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(packData);
+    CloseHandle(packMapping);
+    packMapping = NULL;
+#elif defined(ASSET_PACK_MAPPED)
+    munmap((void *)packData, packSize);
+#endif
+}
+
+// One read of the whole file, for platforms without mapping such as the web build's MEMFS
+static bool ReadPackFile(const char *fileName)
+{
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) return false;
+
+    unsigned char *data = NULL;
+    long size = (fseek(file, 0, SEEK_END) == 0) ? ftell(file) : -1;
+    bool ok = (size > 0) && (fseek(file, 0, SEEK_SET) == 0);
+    if (ok) data = (unsigned char *)malloc((size_t)size);
+    ok = ok && (data != NULL) && (fread(data, 1, (size_t)size, file) == (size_t)size);
+    fclose(file);
+    if (!ok) {
+        free(data);
+        return false;
+    }
+
+    packData = data;
+    packSize = (size_t)size;
+    return true;
+}
+
+// Reject anything whose table points outside the file, so lookups need no further checks
+static bool ValidatePack(void)
+{
+    if (packSize < (size_t)ASSET_PACK_HEADER_SIZE || memcmp(packData, "PPAK", 4) != 0) return false;
+    if (GetU32(packData + 4) != (uint32_t)ASSET_PACK_VERSION) return false;
+
+    uint32_t count = GetU32(packData + 8);
+    if (count > (packSize - ASSET_PACK_HEADER_SIZE) / ASSET_PACK_ENTRY_SIZE) return false;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const unsigned char *entry = GetEntry((int)i);
+        uint64_t offset = GetU32(entry + ASSET_PACK_NAME_SIZE);
+        uint64_t size = GetU32(entry + ASSET_PACK_NAME_SIZE + 4);
+        if (entry[ASSET_PACK_NAME_SIZE - 1] != '\0') return false;
+        if (offset + size + 1 > packSize || packData[offset + size] != '\0') return false;
+    }
+
+    entryCount = (int)count;
+    return true;
+}
+
+//----------------------------------------------------------------------------------
+// Module functions
+//----------------------------------------------------------------------------------
+bool OpenAssetPack(const char *fileName)
+{
+    CloseAssetPack();
+
+    packMapped = MapPackFile(fileName);
+    if (!packMapped && !ReadPackFile(fileName)) return false;
+
+    if (!ValidatePack()) {
+        CloseAssetPack();
+        return false;
+    }
+    return true;
+}
+
+void CloseAssetPack(void)
+{
+    if (packData != NULL) {
+        if (packMapped) UnmapPackFile();
+        else free((void *)packData);
+    }
+    packData = NULL;
+    packSize = 0;
+    entryCount = 0;
+    packMapped = false;
+}
+
+bool IsAssetPackOpen(void)
+{
+    return packData != NULL;
+}
+
+const unsigned char *GetAssetData(const char *name, int *size)
+{
+    int low = 0, high = entryCount - 1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        const unsigned char *entry = GetEntry(middle);
+        int order = strcmp(name, (const char *)entry);
+        if (order == 0) {
+            if (size != NULL) *size = (int)GetU32(entry + ASSET_PACK_NAME_SIZE + 4);
+            return packData + GetU32(entry + ASSET_PACK_NAME_SIZE);
+        }
+        if (order < 0) high = middle - 1;
+        else low = middle + 1;
+    }
+    return NULL;
+}
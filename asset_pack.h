@@ -0,0 +1,36 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+//----------------------------------------------------------------------------------
+// Asset pack: every file under resources/ in one indexed archive, built by
+// tools/pack_assets.cpp (make assets). At startup the whole pack is memory mapped
+// on desktop, or read with a single call where mapping isn't available (the web
+// build preloads it as one blob), and assets are decoded straight from that memory
+// No raylib dependency, callers hand the bytes to the LoadXFromMemory() functions
+//
+// File layout, little-endian:
+//   char[4]  magic "PPAK"
+//   uint32   version
+//   uint32   entry count
+//   uint32   reserved
+//   entries, sorted by name for binary search, ASSET_PACK_ENTRY_SIZE bytes each:
+//     char[120]  path as passed to the loaders, e.g. "resources/gamelost.mp3", NUL padded
+//     uint32     data offset from the start of the file, 16-byte aligned
+//     uint32     data size in bytes
+//   data, each entry followed by a NUL byte so text assets are C strings in place
+//----------------------------------------------------------------------------------
+
+static const int ASSET_PACK_VERSION = 1;
+static const int ASSET_PACK_HEADER_SIZE = 16;
+static const int ASSET_PACK_NAME_SIZE = 120;
+static const int ASSET_PACK_ENTRY_SIZE = ASSET_PACK_NAME_SIZE + 8;
+
+bool OpenAssetPack(const char *fileName);      // False if missing or invalid, callers then use loose files
+void CloseAssetPack(void);                      // Invalidates every pointer GetAssetData() returned
+bool IsAssetPackOpen(void);
+
+// Asset bytes by path, NULL if the pack is closed or doesn't have it
+// The data stays valid until CloseAssetPack() and is always followed by a NUL byte
+const unsigned char *GetAssetData(const char *name, int *size);
+
+#endif // ASSET_PACK_H
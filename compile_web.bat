@@ -5,18 +5,27 @@ CALL path\to\emsdk\emsdk_env.bat
 REM Change to project directory
 cd e:\Raylib_Cpp_1
 
+REM Pack resources/ into one archive, the page fetches it as a single preloaded blob
+g++ -std=c++14 -O2 -I. -o pack_assets.exe tools/pack_assets.cpp
+pack_assets.exe resources.pak resources
+if %ERRORLEVEL% NEQ 0 (
+  echo Asset packing failed with error code %ERRORLEVEL%
+  exit /b %ERRORLEVEL%
+)
+
 REM Compile the game using custom shell file
-emcc main.cpp -o pong.html ^
+emcc main.cpp pong_sim.cpp replay.cpp text_cache.cpp profiler.cpp particles.cpp game_audio.cpp asset_pack.cpp net_socket.cpp netplay.cpp sim_thread.cpp telemetry.cpp level.cpp -o pong.html ^
   -Os ^
+  -msimd128 ^
   -s USE_GLFW=3 ^
   -s FULL_ES2=1 ^
-  -s ASYNCIFY ^
   -s WASM=1 ^
   -s NO_EXIT_RUNTIME=1 ^
   -I"C:/raylib/raylib/src" ^
   "C:/raylib/raylib/src/libraylib.web.a" ^
   -s TOTAL_MEMORY=67108864 ^
   -s ALLOW_MEMORY_GROWTH=1 ^
+  --preload-file resources.pak ^
   --shell-file shell.html
 
 REM If compilation was successful
@@ -0,0 +1,133 @@
+#include "game_audio.h"
+#include "asset_pack.h"
+#include "spsc_queue.h"
+
+#include <raylib.h>
+#include <cstring>
+
+//----------------------------------------------------------------------------------
+// Clips and voice pools
+//----------------------------------------------------------------------------------
+static const int MAX_VOICES = 8;
+
+struct SoundClip {
+    const char *fileName;
+    int voiceCount;             // Simultaneous plays before the oldest voice is cut off
+    float volume;               // Base volume, scaled by each request
+    float pitch;                // Base pitch, scaled by each request
+};
+
+// The wall bounce reuses the paddle clip, quieter and higher
+static const SoundClip clips[SFX_COUNT] = {
+    { "resources/TunePocket-Ping-Pong-Ball-Bouce-Hit-Preview.mp3", 8, 1.0f, 1.0f },    // SFX_PADDLE_HIT
+    { "resources/TunePocket-Ping-Pong-Ball-Bouce-Hit-Preview.mp3", 6, 0.5f, 1.35f },   // SFX_WALL_HIT
+    { "resources/box-crash-106687.mp3", 2, 0.8f, 1.0f },                               // SFX_SCORE
+    { "resources/game-start-6104.mp3", 1, 0.8f, 1.0f },                                // SFX_GAME_START
+    { "resources/gamelost.mp3", 1, 0.8f, 1.0f }                                        // SFX_GAME_LOST
+};
+
+struct VoicePool {
+    Sound voices[MAX_VOICES];
+    int count;
+    int next;                   // Round-robin start for the free voice search
+};
+
+struct SoundRequest {
+    SoundEffect effect;
+    float volume, pitch, pan;
+};
+
+static VoicePool pools[SFX_COUNT];
+static SpscQueue<SoundRequest, 64> requests;
+static bool audioReady = false;
+
+// Decode a clip from the asset pack, or from the loose file when there is no pack
+static Wave LoadClipWave(const char *fileName)
+{
+    int size = 0;
+    const unsigned char *data = GetAssetData(fileName, &size);
+    if (data != NULL) return LoadWaveFromMemory(GetFileExtension(fileName), data, size);
+    if (FileExists(fileName)) return LoadWave(fileName);
+    return (Wave){ 0 };
+}
+
+// Prefer an idle voice, otherwise cut off the one started longest ago
+static Sound *AcquireVoice(VoicePool *pool)
+{
+    for (int i = 0; i < pool->count; i++) {
+        int index = (pool->next + i) % pool->count;
+        if (!IsSoundPlaying(pool->voices[index])) {
+            pool->next = (index + 1) % pool->count;
+            return &pool->voices[index];
+        }
+    }
+
+    Sound *oldest = &pool->voices[pool->next];
+    pool->next = (pool->next + 1) % pool->count;
+    StopSound(*oldest);
+    return oldest;
+}
+
+//----------------------------------------------------------------------------------
+// Module functions
+//----------------------------------------------------------------------------------
+void InitGameAudio(void)
+{
+    ResetSpscQueue(&requests);
+    if (!IsAudioDeviceReady()) return;
+
+    // Clips shared between effects are decoded once
+    Wave waves[SFX_COUNT];
+    for (int i = 0; i < SFX_COUNT; i++) {
+        waves[i] = (Wave){ 0 };
+        for (int j = 0; j < i; j++) {
+            if (strcmp(clips[j].fileName, clips[i].fileName) == 0) waves[i] = waves[j];
+        }
+        if (waves[i].data == NULL) waves[i] = LoadClipWave(clips[i].fileName);
+
+        pools[i].count = 0;
+        pools[i].next = 0;
+        if (waves[i].data == NULL) continue;
+        for (int v = 0; v < clips[i].voiceCount && v < MAX_VOICES; v++) {
+            pools[i].voices[pools[i].count++] = LoadSoundFromWave(waves[i]);
+        }
+    }
+
+    for (int i = 0; i < SFX_COUNT; i++) {
+        bool shared = false;
+        for (int j = 0; j < i; j++) shared = shared || (waves[j].data == waves[i].data);
+        if (!shared && waves[i].data != NULL) UnloadWave(waves[i]);
+    }
+    audioReady = true;
+}
+
+void UnloadGameAudio(void)
+{
+    if (!audioReady) return;
+    for (int i = 0; i < SFX_COUNT; i++) {
+        for (int v = 0; v < pools[i].count; v++) UnloadSound(pools[i].voices[v]);
+        pools[i].count = 0;
+    }
+    audioReady = false;
+}
+
+void QueueSound(SoundEffect effect, float volume, float pitch, float pan)
+{
+    SoundRequest request = { effect, volume, pitch, pan };
+    PushSpscQueue(&requests, request);
+}
+
+void UpdateGameAudio(void)
+{
+    SoundRequest request;
+    while (PopSpscQueue(&requests, &request)) {
+        VoicePool *pool = &pools[request.effect];
+        if (!audioReady || pool->count == 0) continue;
+
+        Sound *voice = AcquireVoice(pool);
+        SetSoundVolume(*voice, clips[request.effect].volume * request.volume);
+        SetSoundPitch(*voice, clips[request.effect].pitch * request.pitch);
+        SetSoundPan(*voice, request.pan);
+        PlaySound(*voice);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef GAME_AUDIO_H
+#define GAME_AUDIO_H
+
+//----------------------------------------------------------------------------------
+// Game audio: every clip is decoded to PCM once at startup and copied into a small
+// pool of voices, so overlapping hits each play on their own voice instead of
+// restarting one sound. Gameplay code only queues requests, which never blocks;
+// UpdateGameAudio() drains them once per frame and starts the voices
+//----------------------------------------------------------------------------------
+
+enum SoundEffect {
+    SFX_PADDLE_HIT,
+    SFX_WALL_HIT,
+    SFX_SCORE,
+    SFX_GAME_START,
+    SFX_GAME_LOST,
+    SFX_COUNT
+};
+
+void InitGameAudio(void);       // Decode clips and build voice pools, call after InitAudioDevice()
+void UnloadGameAudio(void);
+
+// Producer side, safe from one thread other than the one calling UpdateGameAudio()
+// pan: as raylib 4.5 SetSoundPan() takes it, 1.0 left to 0.0 right, 0.5 centered. Dropped when the queue is full
+void QueueSound(SoundEffect effect, float volume, float pitch, float pan);
+void UpdateGameAudio(void);     // Consumer side, start every queued sound
+
+#endif // GAME_AUDIO_H
@@ -0,0 +1,221 @@
+#include "level.h"
+
+#include <cctype>
+#include <cmath>
+
+static const float LANE_MARGIN = 100.0f;            // Kept clear in front of each paddle
+static const float SERVE_LANE = 40.0f;              // Half width of the clear lane down the center
+static const float SERVE_PATH_CLEARANCE = 26.0f;    // Kept clear either side of the serve diagonals, past the ball's radius
+
+static Level levels[LEVEL_COUNT];
+
+//----------------------------------------------------------------------------------
+// Module Internal Functions
+//----------------------------------------------------------------------------------
+// Obstacles in a paddle lane or the serving lane are dropped, so every level keeps the
+// serve and the returns playable
+static void AddObstacle(Level *level, ObstacleType type, float x, float y, float width, float height)
+{
+    float centerX = COURT_X + COURT_WIDTH / 2.0f;
+    if (x < COURT_X + LANE_MARGIN || x + width > COURT_X + COURT_WIDTH - LANE_MARGIN) return;
+    if (x < centerX + SERVE_LANE && x + width > centerX - SERVE_LANE) return;
+    if (level->obstacleCount >= LEVEL_MAX_OBSTACLES) return;
+
+    Obstacle &obstacle = level->obstacles[level->obstacleCount++];
+    obstacle = (Obstacle){ type, x, y, width, height, 0.0f, 0, 0 };
+}
+
+// The left half of a symmetric layout, the right half is its mirror image
+static void AddMirrored(Level *level, ObstacleType type, float x, float y, float width, float height)
+{
+    AddObstacle(level, type, x, y, width, height);
+    AddObstacle(level, type, 2 * COURT_X + COURT_WIDTH - x - width, y, width, height);
+}
+
+static void AddMovingWall(Level *level, float x, float height, int period, int phase)
+{
+    int first = level->obstacleCount;
+    AddObstacle(level, OBSTACLE_MOVING_WALL, x, COURT_Y + 10.0f, 16.0f, height);
+    if (level->obstacleCount == first) return;
+
+    Obstacle &wall = level->obstacles[first];
+    wall.travel = COURT_HEIGHT - 20.0f - height;
+    wall.period = period;
+    wall.phase = phase;
+}
+
+// Every serve leaves the center on a 45 degree diagonal. Bricks are rebuilt after each point and
+// bumpers never go, so either one on those diagonals would send every serve down the same path
+// and the serve, not the players, would decide the point
+static bool CrossesServePath(float x, float y, float width, float height)
+{
+    float centerX = COURT_X + COURT_WIDTH / 2.0f, centerY = COURT_Y + COURT_HEIGHT / 2.0f;
+
+    // f is 0 on the diagonals. Its extremes over the box are at the corners, or on the center row
+    float nearestY = fminf(fmaxf(centerY, y), y + height);
+    float cornersX[2] = { x, x + width };
+    float cornersY[3] = { y, y + height, nearestY };
+    float minF = INFINITY, maxF = -INFINITY;
+    for (float px : cornersX) {
+        for (float py : cornersY) {
+            float f = fabsf(py - centerY) - fabsf(centerX - px);
+            minF = fminf(minF, f);
+            maxF = fmaxf(maxF, f);
+        }
+    }
+    return minF < SERVE_PATH_CLEARANCE && maxF > -SERVE_PATH_CLEARANCE;
+}
+
+static void BuildBricks(Level *level)
+{
+    // Three staggered columns of bricks on each side. The gaps are wider than the ball, so a ball
+    // that gets in among the columns always has a way back out, and the serve diagonals stay clear
+    const float width = 24.0f, height = 40.0f, pitch = 70.0f;
+    for (int column = 0; column < 3; column++) {
+        float x = 250.0f + column * 70;
+        float offset = (column % 2 == 1) ? pitch / 2 : 0.0f;
+        for (float y = COURT_Y + 12.0f + offset; y + height <= COURT_Y + COURT_HEIGHT - 12; y += pitch) {
+            if (CrossesServePath(x, y, width, height)) continue;
+            AddMirrored(level, OBSTACLE_BRICK, x, y, width, height);
+        }
+    }
+}
+
+static void BuildBumpers(Level *level)
+{
+    // A diamond of bumpers on each side, between the serve diagonals
+    static const float layout[][2] = {
+        { 200, 0.50f }, { 260, 0.32f }, { 260, 0.68f }, { 320, 0.50f }, { 380, 0.50f }
+    };
+    for (const float *spot : layout) {
+        float y = COURT_Y + spot[1] * COURT_HEIGHT - 14;
+        if (CrossesServePath(spot[0], y, 28, 28)) continue;
+        AddMirrored(level, OBSTACLE_BUMPER, spot[0], y, 28, 28);
+    }
+}
+
+static void BuildGates(Level *level)
+{
+    // Walls sliding out of step with each other, mirrored in position but not in timing
+    AddMovingWall(level, 250.0f, 150.0f, 4 * SIM_TICK_RATE, 0);
+    AddMovingWall(level, 390.0f, 110.0f, 3 * SIM_TICK_RATE, SIM_TICK_RATE);
+    AddMovingWall(level, 2 * COURT_X + COURT_WIDTH - 390.0f - 16, 110.0f, 3 * SIM_TICK_RATE, 2 * SIM_TICK_RATE);
+    AddMovingWall(level, 2 * COURT_X + COURT_WIDTH - 250.0f - 16, 150.0f, 4 * SIM_TICK_RATE, 2 * SIM_TICK_RATE);
+    AddMirrored(level, OBSTACLE_BUMPER, 320.0f, COURT_Y + 10.0f, 28, 28);
+    AddMirrored(level, OBSTACLE_BUMPER, 320.0f, COURT_Y + COURT_HEIGHT - 38.0f, 28, 28);
+}
+
+static void BuildMosaic(Level *level)
+{
+    // Bands of small bricks across both halves, three rows deep, with a channel between bands just
+    // wide enough for the ball. A ball in a channel chips at the bands on either side as it goes
+    // through, a ball meeting the end of a band is sent back. Bricks are wide enough that no ball
+    // skips over one in a tick
+    const float size = 12.0f, pitch = 14.0f, channel = 36.0f;
+    for (float band = COURT_Y + 8.0f; band + 3 * pitch <= COURT_Y + COURT_HEIGHT; band += 3 * pitch + channel) {
+        for (int row = 0; row < 3; row++) {
+            for (float x = COURT_X + LANE_MARGIN + 15; x + size <= COURT_X + COURT_WIDTH / 2.0f - SERVE_LANE; x += pitch) {
+                AddMirrored(level, OBSTACLE_BRICK, x, band + row * pitch, size, size);
+            }
+        }
+    }
+}
+
+// Counting sort of every obstacle into the cells it overlaps
+static void BuildLevelGrid(Level *level)
+{
+    static int cellCounts[LEVEL_GRID_CELLS];
+    for (int c = 0; c < LEVEL_GRID_CELLS; c++) cellCounts[c] = 0;
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < level->obstacleCount; i++) {
+            const Obstacle &obstacle = level->obstacles[i];
+            LevelCellRange cells = GetLevelCells(obstacle.x, obstacle.y, obstacle.x + obstacle.width,
+                                                 obstacle.y + obstacle.travel + obstacle.height);
+            for (int row = cells.row0; row <= cells.row1; row++) {
+                for (int column = cells.column0; column <= cells.column1; column++) {
+                    int c = row * LEVEL_GRID_COLUMNS + column;
+                    if (pass == 0) cellCounts[c]++;
+                    else level->cellItems[level->cellStart[c] + cellCounts[c]++] = (uint16_t)i;
+                }
+            }
+        }
+
+        if (pass == 0) {
+            level->cellStart[0] = 0;
+            for (int c = 0; c < LEVEL_GRID_CELLS; c++) {
+                level->cellStart[c + 1] = level->cellStart[c] + cellCounts[c];
+                cellCounts[c] = 0;
+            }
+        }
+    }
+}
+
+static bool BuildLevels(void)
+{
+    static const char *names[LEVEL_COUNT] = { "CLASSIC", "BRICKS", "BUMPERS", "GATES", "MOSAIC" };
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        Level *level = &levels[i];
+        level->name = names[i];
+        level->obstacleCount = 0;
+        switch (i) {
+            case LEVEL_BRICKS: BuildBricks(level); break;
+            case LEVEL_BUMPERS: BuildBumpers(level); break;
+            case LEVEL_GATES: BuildGates(level); break;
+            case LEVEL_MOSAIC: BuildMosaic(level); break;
+            default: break;
+        }
+        BuildLevelGrid(level);
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------
+// Module functions
+//----------------------------------------------------------------------------------
+const Level *GetLevel(int level)
+{
+    // Built on first use. Static initialization is thread safe, so the sim thread and the
+    // renderer can both get here first
+    static const bool built = BuildLevels();
+    (void)built;
+
+    if (level < 0 || level >= LEVEL_COUNT) level = LEVEL_CLASSIC;
+    return &levels[level];
+}
+
+int FindLevel(const char *name)
+{
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        const char *levelName = GetLevel(i)->name;
+        int c = 0;
+        while (name[c] != '\0' && toupper((unsigned char)name[c]) == levelName[c]) c++;
+        if (name[c] == '\0' && levelName[c] == '\0') return i;
+    }
+    return -1;
+}
+
+float GetObstacleY(const Obstacle *obstacle, float tick)
+{
+    if (obstacle->type != OBSTACLE_MOVING_WALL) return obstacle->y;
+
+    // Triangle wave, down for the first half of the period and back up for the second
+    float cycle = fmodf(tick + obstacle->phase, (float)obstacle->period) / obstacle->period;
+    float down = (cycle < 0.5f) ? 2.0f * cycle : 2.0f - 2.0f * cycle;
+    return obstacle->y + obstacle->travel * down;
+}
+
+LevelCellRange GetLevelCells(float minX, float minY, float maxX, float maxY)
+{
+    LevelCellRange cells;
+    cells.column0 = (int)floorf((minX - COURT_X) / LEVEL_GRID_CELL);
+    cells.row0 = (int)floorf((minY - COURT_Y) / LEVEL_GRID_CELL);
+    cells.column1 = (int)floorf((maxX - COURT_X) / LEVEL_GRID_CELL);
+    cells.row1 = (int)floorf((maxY - COURT_Y) / LEVEL_GRID_CELL);
+
+    if (cells.column0 < 0) cells.column0 = 0;
+    if (cells.row0 < 0) cells.row0 = 0;
+    if (cells.column1 > LEVEL_GRID_COLUMNS - 1) cells.column1 = LEVEL_GRID_COLUMNS - 1;
+    if (cells.row1 > LEVEL_GRID_ROWS - 1) cells.row1 = LEVEL_GRID_ROWS - 1;
+    return cells;
+}
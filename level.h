@@ -0,0 +1,78 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+//----------------------------------------------------------------------------------
+// Court levels: obstacles placed between the paddles, and the broadphase that finds them
+//
+// Bricks break when the scoring ball hits them and are rebuilt after every point.
+// Bumpers never break and kick the ball back faster. Moving walls slide up and down on a
+// fixed cycle; where they are is a function of the tick, so they add nothing to PongSim
+// and rollback and replays get them for free. Only the broken bricks are match state,
+// a bitset in PongSim
+//
+// Levels are built once, the first time one is asked for, and never change afterwards,
+// so any thread can read them. Each level files its obstacles in a uniform grid over the
+// court, every cell listing the obstacles that overlap it, a moving wall in every cell of
+// its whole travel. A ball only tests the obstacles in the few cells its move covers, so
+// a collision query costs the same with ten obstacles or four thousand
+//
+// Obstacles stay out of the paddle lanes and out of the serving lane down the center, and bricks
+// and bumpers stay off the diagonals every serve starts along
+//----------------------------------------------------------------------------------
+#include "pong_sim.h"
+
+static const int LEVEL_GRID_CELL = 32;                  // Pixels, about two ball diameters
+static const int LEVEL_GRID_COLUMNS = (COURT_WIDTH + LEVEL_GRID_CELL - 1) / LEVEL_GRID_CELL;
+static const int LEVEL_GRID_ROWS = (COURT_HEIGHT + LEVEL_GRID_CELL - 1) / LEVEL_GRID_CELL;
+static const int LEVEL_GRID_CELLS = LEVEL_GRID_COLUMNS * LEVEL_GRID_ROWS;
+static const int LEVEL_GRID_MAX_ENTRIES = 4 * LEVEL_MAX_OBSTACLES;
+
+static const float BUMPER_KICK = 1.15f;                 // Speed gained off a bumper, still held to params.maxSpeed
+static const float OBSTACLE_MIN_SPEED_X = 5.0f;         // A glancing corner hit never leaves the ball crawling between walls
+
+enum LevelId {
+    LEVEL_CLASSIC,                      // The bare court
+    LEVEL_BRICKS,
+    LEVEL_BUMPERS,
+    LEVEL_GATES,
+    LEVEL_MOSAIC,                       // Over a thousand small bricks
+    LEVEL_COUNT
+};
+
+enum ObstacleType {
+    OBSTACLE_BRICK,
+    OBSTACLE_BUMPER,
+    OBSTACLE_MOVING_WALL
+};
+
+struct Obstacle {
+    ObstacleType type;
+    float x, y;                         // Top left, for a moving wall at the top of its travel
+    float width, height;
+    float travel;                       // Moving wall: how far down it goes
+    int period;                         // Moving wall: ticks for the trip down and back
+    int phase;                          // Moving wall: ticks into the cycle at tick 0
+};
+
+struct Level {
+    const char *name;
+    int obstacleCount;
+    Obstacle obstacles[LEVEL_MAX_OBSTACLES];
+
+    // Obstacles overlapping cell c are cellItems[cellStart[c]] up to cellItems[cellStart[c + 1]]
+    int cellStart[LEVEL_GRID_CELLS + 1];
+    uint16_t cellItems[LEVEL_GRID_MAX_ENTRIES];
+};
+
+// A range of grid cells, inclusive
+struct LevelCellRange {
+    int column0, row0;
+    int column1, row1;
+};
+
+const Level *GetLevel(int level);                               // LEVEL_CLASSIC for anything out of range
+int FindLevel(const char *name);                                // Case-insensitive, -1 when no level has that name
+float GetObstacleY(const Obstacle *obstacle, float tick);       // Top edge at a tick, fractional ticks for drawing
+LevelCellRange GetLevelCells(float minX, float minY, float maxX, float maxY);  // Cells a box touches, clamped to the court
+
+#endif // LEVEL_H
@@ -1,33 +1,34 @@
 #include <iostream>
 #include <raylib.h>
+#include <rlgl.h>
 #include <string>
 #include <cstring>
 #include <cmath>
+#include <ctime>
+
+#include "pong_sim.h"
+#include "replay.h"
+#include "text_cache.h"
+#include "profiler.h"
+#include "particles.h"
+#include "game_audio.h"
+#include "asset_pack.h"
+#include "netplay.h"
+#include "sim_thread.h"
+#include "telemetry.h"
+#include "level.h"
 
 #if defined(PLATFORM_WEB)
     #include <emscripten/emscripten.h>
 #endif
 
-using namespace std;
-
-// Structure for the paddles
-struct Paddle {
-    float x, y;
-    float width, height;
-    float speed;
-    Color color;
-    float velocityY; // For smooth movement
-};
+#if defined(PLATFORM_DESKTOP)
+    #define GLSL_VERSION            330
+#else   // PLATFORM_ANDROID, PLATFORM_WEB
+    #define GLSL_VERSION            100
+#endif
 
-// Structure for the ball
-struct Ball {
-    float x, y;
-    float speedX, speedY;
-    float radius;
-    Color color;
-    float impossibleSpeedMultiplier; // Speed multiplier for IMPOSSIBLE mode
-    int hitCounter;                 // Track consecutive hits for IMPOSSIBLE mode
-};
+using namespace std;
 
 // Game state
 enum GameState {
@@ -39,66 +40,219 @@ enum GameState {
     GAME_OVER
 };
 
-// Difficulty levels
-enum DifficultyLevel {
-    EASY,
-    MEDIUM,
-    HARD,
-    IMPOSSIBLE
-};
-
 //----------------------------------------------------------------------------------
 // Global Variables Definition
 //----------------------------------------------------------------------------------
-static const int SCREEN_WIDTH = 1024;
-static const int SCREEN_HEIGHT = 768;
-
-// Constants for the court area - with a border
-static const int COURT_BORDER_X = 5;
-static const int COURT_BORDER_Y = 75;
-static const int COURT_X = COURT_BORDER_X;
-static const int COURT_Y = COURT_BORDER_Y;
-static const int COURT_WIDTH = SCREEN_WIDTH - (2 * COURT_BORDER_X);
-static const int COURT_HEIGHT = SCREEN_HEIGHT - (2 * COURT_BORDER_Y);
-
-// Game state and difficulty
+// Game state
 static GameState currentState = MAIN_MENU;
-static DifficultyLevel currentDifficulty = MEDIUM;
 
 // Player Name
 static char playerName[32] = "Player";
 static int letterCount = 0;
 
-// Game elements
-static Paddle playerPaddle;
-static Paddle computerPaddle;
-static Ball ball;
+// Game elements: paddles, ball, scores and difficulty all live in the simulation
+static PongSim sim;
 static Camera2D camera = { 0 };
 
-// Score and effects
-static int playerScore = 0;
-static int computerScore = 0;
+// Effects
 static float screenShake = 0.0f;
+static PongRng fxRng;           // Random stream for cosmetic effects, kept apart from the simulation's
+
+// Replays: every live match is recorded, and --replay plays a file back through the same tick path
+static Replay recording;
+static bool recordingUnsaved = false;
+static Replay loadedReplay;
+static ReplayPlayback playback;
+static bool replayActive = false;           // GAMEPLAY ticks read inputs from the replay instead of the keyboard
+static bool replayFast = false;             // Run as many ticks per frame as fit in the frame budget
+static const double REPLAY_FAST_BUDGET = 0.012;     // Seconds of simulation work per fast-forward frame
+static const int REPLAY_SEEK_TICKS = 5 * SIM_TICK_RATE;
+
+// Fixed-timestep simulation, see pong_sim.h for the tick rate
+static const float MAX_FRAME_TIME = 0.25f;   // Clamp long stalls so the simulation doesn't spiral
+static float tickAccumulator = 0.0f;
+
+// Positions at the start of the last tick, used to interpolate rendering between ticks
+static Vector2 prevBallPosition = { 0 };
+static float prevPlayerPaddleY = 0.0f;
+static float prevComputerPaddleY = 0.0f;
+static float prevExtraBallX[SIM_MAX_BALLS];
+static float prevExtraBallY[SIM_MAX_BALLS];
+
+// Low latency mode (--low-latency, F5): vsync off, so raylib's frame limiter sleeps right before
+// input is polled instead of the swap blocking after it, and the local paddle is drawn from this
+// frame's input rather than interpolated a tick behind. Trades tearing for a frame less of lag
+static bool lowLatency = false;
+static unsigned int frameInput = 0;         // Paddle keys sampled this frame
+static double frameStartTime = 0.0;         // Just after raylib polled input for this frame
+#if !defined(PLATFORM_WEB)
+static int pacedFps = 60;                   // Frame limiter target at full rate, the display's refresh rate
+#endif
+
+// Latency test (F6): a paddle key press flashes the screen white for one frame and logs the time from
+// the input poll to the present, the flash also lets a camera or photodiode measure the full path
+static bool latencyTest = false;
+static bool latencyFlash = false;
+static float latencyLastMs = 0.0f;
+static float latencyAverageMs = 0.0f;
+static int latencySamples = 0;
+
+// Idle throttling: screens where only the background drifts redraw at IDLE_FPS, and an unfocused or
+// minimized window sleeps until the next window event. Gameplay, online matches and any input switch
+// back to full rate before the frame is presented, so the next frame's time step is a normal one
+enum PresentRate {
+    PRESENT_FULL,
+    PRESENT_IDLE,
+    PRESENT_ASLEEP
+};
+static const int IDLE_FPS = 20;
+static const double IDLE_INPUT_HOLD = 0.5;     // Seconds at full rate after the last input, keeps menus responsive
+static PresentRate presentRate = PRESENT_FULL;
+static double lastInputTime = 0.0;
+
+// Render benchmark (--bench FRAMES): every GameState drawn offscreen with a fixed frame time
+static bool benchMode = false;
+static const float BENCH_FRAME_TIME = 1.0f / 60.0f;
+static const int BENCH_WARMUP_FRAMES = 30;
+
+// Online play: the host is the left paddle, a joining peer the right one, see netplay.h
+static NetplaySession netplay;
+static bool netplayActive = false;          // GAMEPLAY ticks go through the rollback session, the match can't pause
+
+// Threaded simulation (--threaded, desktop): live matches tick on their own thread and the frame
+// renders the latest snapshot, see sim_thread.h. Replays and online matches stay on the main thread
+static bool threadedSim = false;
+static double simSnapshotTime = 0.0;        // When the rendered snapshot's tick ran, on the sim thread's clock
+
+// Telemetry (--telemetry [FILE]): live and online matches log their hits and points, see telemetry.h
+static bool telemetryActive = false;
+static bool telemetryMatchOpen = false;     // MATCH_START went out, a MATCH_END is still owed
+
+// Multi-ball mode, toggled before a match starts
+static bool multiBall = false;
+static const int MULTIBALL_EXTRA_BALLS = 499;   // Plus the scoring ball, a 500-ball round
+
+// Court level (--level NAME, L before a match): the obstacles between the paddles, see level.h
+static int courtLevel = LEVEL_CLASSIC;
+static const int LEVEL_DRAW_CHUNK = 1024;      // Quads per batch check, the web batch holds 2048
 
 // Trail and stars
-static const int TRAIL_LENGTH = 15;
-static Vector2 ballTrail[TRAIL_LENGTH] = { 0 };
+static const int TRAIL_MAX_LENGTH = 256;
+static int trailLength = 64;                // Samples in the ball trail, one per frame, --trail SAMPLES
+static Vector2 ballTrail[TRAIL_MAX_LENGTH] = { 0 };
 static int trailIndex = 0;
+static int trailCount = 0;                  // Samples since the ball was last served
 static const int numStars = 80;
 static Vector2 stars[numStars];
 
-// Sounds
-static Sound paddleHit, wallHit, score;
+// Static scene layers, built once at startup so a frame only draws a few textured batches
+static RenderTexture2D courtTexture;        // Court border and center line
+static Texture2D starTexture;               // Soft circle sprite shared by every star
+static Texture2D ballTexture;               // Anti-aliased circle sprite for multi-ball's extra balls
+static Shader starShader;                   // Twinkle computed per fragment
+static int starTimeLoc = -1;
+static bool starShaderLoaded = false;       // Without it the twinkle falls back to the CPU
+static const float STAR_SPRITE_SCALE = 1.35f;   // Sprite half-size per unit of star radius, the sprite edge is soft
+
+// Post-processing: the scene renders into sceneTarget, then one pass scales it onto the window and the
+// shader, when it loaded, adds scanlines, bloom and shake
+static RenderTexture2D sceneTarget = { 0 };
+static Shader postShader;
+static bool postShaderLoaded = false;       // Without it the pass is a plain scaled copy and the camera shakes
+static int postResolutionLoc = -1;
+static int postShakeLoc = -1;
+static int postScanlinesLoc = -1;
+static int postBloomLoc = -1;
+
+// Dynamic resolution: gameplay and layout stay in the SCREEN_WIDTH x SCREEN_HEIGHT virtual canvas, which
+// renders at renderScale into sceneTarget and is letterboxed onto the window. Every DYNRES_WINDOW frames
+// the scale steps down if frames missed refreshes, and after a stretch with headroom it tries a step up.
+// Vsync, the frame limiter and the browser all pace frames to the refresh rate, so frame time can't show
+// headroom. That comes from the frame's work time instead, see UpdateRenderScale()
+static const float RENDER_SCALE_MIN = 0.5f;
+static const float RENDER_SCALE_MAX = 2.0f;         // HiDPI and large windows, capped by the window's own pixels
+static const float RENDER_SCALE_STEP = 0.125f;
+static const int DYNRES_WINDOW = 30;                // Frames per measurement
+static const int DYNRES_UP_HOLD = 4;                // Measurements with headroom before trying a step up
+static const int DYNRES_UP_HOLD_MAX = 64;
+static const float DYNRES_WORK_HEADROOM = 0.5f;     // Work time under this share of the refresh interval leaves room to step up
+static float renderScale = 1.0f;
+static float fixedRenderScale = 0.0f;               // --render-scale S pins the scale, 0 lets the controller pick
+static Rectangle presentRect = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };   // The canvas in window pixels
+static int dynresFrames = 0;
+static float dynresTime = 0.0f;
+static float dynresWork = 0.0f;
+static float frameWorkTime = 0.0f;                  // Last frame, from the input poll to submitting it for the swap
+static int dynresHeadroom = 0;                      // Measurements in a row under budget
+static int dynresUpHold = DYNRES_UP_HOLD;           // Doubles whenever a step up doesn't hold
+static bool dynresProbing = false;                  // The last change was a step up
+
+// Profiler: F3 toggles the overlay, F4 dumps profile.csv and profile_trace.json
+// While it's on, rlgl draws through profileBatch so draw calls can be counted before each flush
+static rlRenderBatch profileBatch;
+static bool profileBatchLoaded = false;
+static bool profileBatchActive = false;
+static int frameDrawCalls = 0;
+static int frameVertices = 0;
+#if defined(PLATFORM_WEB)
+static const int PROFILE_BATCH_ELEMENTS = 2048;     // rlgl's own default for OpenGL ES 2.0
+#else
+static const int PROFILE_BATCH_ELEMENTS = 8192;
+#endif
 
 //----------------------------------------------------------------------------------
 // Module Functions Declaration
 //----------------------------------------------------------------------------------
 void UpdateDrawFrame(void);     // Update and Draw one frame
-void ResetBall(int direction);  // Reset ball position and speed
+static void UpdateGameplayTick(unsigned int input);    // Advance gameplay by one fixed tick
+static void HandleTickEvents(void);                     // Sounds and particles for the tick just simulated
+static void HandleSimEvents(const SimEvent *events, int eventCount);
+static void UpdateThreadedSim(void);                    // Start or stop the sim thread with live play and render its newest snapshot
+static void TakeSimSnapshot(void);
+static void StopThreadedSim(void);                      // Join the sim thread and take back the match
+static void LogEventTelemetry(const SimEvent &event);   // A match's first event also logs its start
+static void LogNetplayTelemetry(void);                  // Online events once no rollback can undo them
+static void EndMatchTelemetry(bool abandoned);
+static void UpdateNetplay(unsigned int input, float frameTime);  // Online ticks, rolled back whenever a prediction was wrong
+static void StartNetplay(int hostPort, const char *joinAddress, DifficultyLevel difficulty, NetConditions conditions);
+static void StopNetplay(void);
+static const char *GetSideName(CourtSide side);         // Name shown for a paddle
+static void RunRenderBenchmark(int frames);             // Print BENCH lines in pong_bench's format, see tools/pong_bench.cpp
+static void ApplyFramePacing(void);                     // Vsync or the low latency frame limiter
+static void UpdatePresentRate(void);                    // Full, idle or asleep for the frame about to be presented
+static float LeadPaddleY(const Paddle &paddle, unsigned int input, float tickAlpha);    // Local paddle one tick ahead
+static void RecordLatencySample(double presentTime);
+static void StartMatch(DifficultyLevel difficulty);     // Start a live match and begin recording it
+static void SaveRecording(void);                        // Write the live match's replay, if there is anything new
+static void SnapInterpolation(void);                    // Render from the current tick with no interpolation
+static bool LoadFragmentShader(const char *fileName, Shader *shader);   // From the asset pack, else the loose file
+static void LoadSceneLayers(void);                      // Bake the court and build the star sprite and shader
+static void UnloadSceneLayers(void);
+static void DrawStarfield(bool twinkle);                // All stars as one batch of textured quads
+static void ApplyMultiBall(void);                       // Add or remove the extra balls before a match starts
+static void ApplyLevel(void);                           // Set the court level before a match starts
+static void DrawLevel(float tick);                      // Every standing obstacle as batches of untextured quads
+static void DrawExtraBalls(float tickAlpha);            // Multi-ball's extra balls as one batch of textured quads
+static void DrawBallTrail(float radius);                // The trail as one tapered strip with per-vertex alpha
+static void DrawParticleLayer(void);                    // Impact particles through their own batch, counted by the profiler
+static void LoadPostProcess(void);                      // Scene render target and post-process shader
+static void UpdatePresentRect(void);                    // Letterbox the canvas into the window and map the mouse onto it
+static void UpdateRenderScale(float frameTime, float workTime);    // Dynamic resolution controller
+static void ResizeSceneTarget(void);                    // Match sceneTarget to renderScale
+static void UnloadPostProcess(void);
+static void UpdateProfileBatch(void);                   // Switch rlgl to the counting batch while profiling
+static void CountBatchedDraws(void);                    // Count the pending draw calls, then flush them
+static void DrawProfilerOverlay(void);
+static void DumpProfile(void);
+
+// Seed for a new match, each match then replays exactly from it
+static uint64_t NewMatchSeed() {
+    return ((uint64_t)time(NULL) << 20) ^ (uint64_t)(GetTime() * 1000000.0);
+}
 
 // Ball trail activation thresholds by difficulty
 static int GetTrailThreshold() {
-    switch(currentDifficulty) {
+    switch(sim.difficulty) {
         case EASY: return 4;
         case MEDIUM: return 3;
         case HARD: return 2;
@@ -110,95 +264,978 @@ static int GetTrailThreshold() {
 //----------------------------------------------------------------------------------
 // Main Entry Point
 //----------------------------------------------------------------------------------
-int main() {
+int main(int argc, char *argv[]) {
+    // Command line: --replay FILE [--fast]
+    //               --host [PORT] | --join HOST:PORT, with --difficulty NAME, --multiball and --level NAME for the host
+    //               --latency MS --jitter MS --loss PCT add artificial network conditions for testing
+    //               --bench [FRAMES] times each screen in a hidden window and exits
+    //               --low-latency starts in low latency mode
+    //               --trail SAMPLES sets the ball trail length, up to 256
+    //               --render-scale S pins the internal resolution, 0.5 to 2 times 1024x768
+    //               --threaded runs live matches on a simulation thread
+    //               --telemetry [FILE] logs gameplay events for tools/pong_telemetry, telemetry.ptl by default
+    const char *replayFile = NULL;
+    const char *telemetryFile = NULL;
+    int benchFrames = 0;
+    int hostPort = 0;
+    const char *joinAddress = NULL;
+    DifficultyLevel onlineDifficulty = MEDIUM;
+    NetConditions conditions = { 0, 0, 0 };
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replayFile = argv[++i];
+        else if (strcmp(argv[i], "--fast") == 0) replayFast = true;
+        else if (strcmp(argv[i], "--host") == 0) hostPort = (i + 1 < argc && argv[i + 1][0] != '-') ? atoi(argv[++i]) : NETPLAY_DEFAULT_PORT;
+        else if (strcmp(argv[i], "--join") == 0 && i + 1 < argc) joinAddress = argv[++i];
+        else if (strcmp(argv[i], "--multiball") == 0) multiBall = true;
+        else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+            int level = FindLevel(argv[++i]);
+            if (level >= 0) courtLevel = level;
+        }
+        else if (strcmp(argv[i], "--low-latency") == 0) lowLatency = true;
+        else if (strcmp(argv[i], "--threaded") == 0) threadedSim = true;
+        else if (strcmp(argv[i], "--telemetry") == 0) telemetryFile = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "telemetry.ptl";
+        else if (strcmp(argv[i], "--render-scale") == 0 && i + 1 < argc) {
+            fixedRenderScale = (float)atof(argv[++i]);
+            if (fixedRenderScale < RENDER_SCALE_MIN) fixedRenderScale = RENDER_SCALE_MIN;
+            if (fixedRenderScale > RENDER_SCALE_MAX) fixedRenderScale = RENDER_SCALE_MAX;
+        }
+        else if (strcmp(argv[i], "--trail") == 0 && i + 1 < argc) {
+            trailLength = atoi(argv[++i]);
+            if (trailLength < 2) trailLength = 2;
+            if (trailLength > TRAIL_MAX_LENGTH) trailLength = TRAIL_MAX_LENGTH;
+        }
+        else if (strcmp(argv[i], "--bench") == 0) benchFrames = (i + 1 < argc && argv[i + 1][0] != '-') ? atoi(argv[++i]) : 300;
+        else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc) conditions.latencyMs = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--jitter") == 0 && i + 1 < argc) conditions.jitterMs = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--loss") == 0 && i + 1 < argc) conditions.lossPercent = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--difficulty") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (strcmp(name, "easy") == 0) onlineDifficulty = EASY;
+            else if (strcmp(name, "hard") == 0) onlineDifficulty = HARD;
+            else if (strcmp(name, "impossible") == 0) onlineDifficulty = IMPOSSIBLE;
+        }
+    }
+
     // Initialization
+    // The benchmark renders as fast as it can, into a window nobody sees, at a fixed scale unless told otherwise
+    if (benchFrames > 0) {
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+        if (fixedRenderScale == 0.0f) fixedRenderScale = 1.0f;
+    } else {
+        SetConfigFlags(lowLatency ? FLAG_WINDOW_RESIZABLE : (FLAG_WINDOW_RESIZABLE | FLAG_VSYNC_HINT));
+    }
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Enhanced Ping Pong Game");
     InitAudioDevice();
 
-    // Initialize Paddles
-    playerPaddle = {COURT_X + 20, SCREEN_HEIGHT / 2 - 60, 20, 120, 10, WHITE, 0};
-    computerPaddle = {COURT_X + COURT_WIDTH - 40, SCREEN_HEIGHT / 2 - 60, 20, 120, 8, RED, 0};
+    // One mapping for every asset, without the pack they load as loose files from resources/
+    if (!OpenAssetPack("resources.pak")) TraceLog(LOG_INFO, "ASSETS: No resources.pak, loading loose files");
+
+    // Initialize paddles and ball
+    SeedRng(&fxRng, (uint64_t)time(NULL));
+    InitPongSim(&sim, MEDIUM, NewMatchSeed());
+    if (replayFile != NULL) {
+        if (LoadReplay(&loadedReplay, replayFile)) {
+            StartReplayPlayback(&playback, &loadedReplay, &sim);
+            replayActive = true;
+            currentState = GAMEPLAY;
+        } else {
+            TraceLog(LOG_WARNING, "REPLAY: Could not load %s", replayFile);
+        }
+    } else if (hostPort > 0 || joinAddress != NULL) {
+        StartNetplay(hostPort, joinAddress, onlineDifficulty, conditions);
+    }
 
-    // Initialize Ball
-    ball = { (float)COURT_X + COURT_WIDTH / 2, (float)COURT_Y + COURT_HEIGHT / 2, 7, 7, 15, WHITE, 1.0f, 0 };    // Initialize effects and background
+    // Initialize effects and background
     camera.zoom = 1.0f;
-    for (int i = 0; i < TRAIL_LENGTH; i++) ballTrail[i] = (Vector2){ ball.x, ball.y };
+    prevBallPosition = (Vector2){ sim.ball.x, sim.ball.y };
+    prevPlayerPaddleY = sim.playerPaddle.y;
+    prevComputerPaddleY = sim.computerPaddle.y;
     for (int i = 0; i < numStars; i++) {
-        stars[i].x = GetRandomValue(0, SCREEN_WIDTH);
-        stars[i].y = GetRandomValue(0, SCREEN_HEIGHT);
+        stars[i].x = RngRange(&fxRng, 0, SCREEN_WIDTH);
+        stars[i].y = RngRange(&fxRng, 0, SCREEN_HEIGHT);
     }
     
-    // Load sounds
-    if (FileExists("resources/paddle_hit.wav")) paddleHit = LoadSound("resources/paddle_hit.wav");
-    if (FileExists("resources/wall_hit.wav")) wallHit = LoadSound("resources/wall_hit.wav"); 
-    if (FileExists("resources/score.wav")) score = LoadSound("resources/score.wav");
+    LoadSceneLayers();
+    InitTextCache();
+    InitParticles();
+    LoadPostProcess();
 
-    ResetBall(0); // Set initial ball state
+    // Decode every clip up front, nothing touches the disk during play
+    InitGameAudio();
 
+    if (telemetryFile != NULL && benchFrames == 0) {
+        telemetryActive = StartTelemetry(telemetryFile);
+        if (!telemetryActive) TraceLog(LOG_WARNING, "TELEMETRY: Could not open %s", telemetryFile);
+    }
+
+    if (benchFrames > 0) {
+        RunRenderBenchmark(benchFrames);
+    } else {
 #if defined(PLATFORM_WEB)
-    SetTargetFPS(60);  // Set to 60 FPS for web version
-    emscripten_set_main_loop(UpdateDrawFrame, 60, 1);
+        // Let requestAnimationFrame pace the loop, gameplay speed comes from the fixed tick
+        emscripten_set_main_loop(UpdateDrawFrame, 0, 1);
 #else
-    SetTargetFPS(60);  // Set to consistent 60 FPS for smoother gameplay
-    // Main game loop
-    while (!WindowShouldClose()) {
-        UpdateDrawFrame();
-    }
+        ApplyFramePacing();
+        // Main game loop
+        while (!WindowShouldClose()) {
+            UpdateDrawFrame();
+        }
 #endif
+    }
 
     // De-Initialization
-    if (paddleHit.frameCount > 0) UnloadSound(paddleHit);
-    if (wallHit.frameCount > 0) UnloadSound(wallHit);
-    if (score.frameCount > 0) UnloadSound(score);
+    StopThreadedSim();
+    StopNetplay();
+    SaveRecording();
+    EndMatchTelemetry(true);
+    if (telemetryActive) {
+        TelemetryStats stats = StopTelemetry();
+        TraceLog(LOG_INFO, "TELEMETRY: %lld events written to %d file(s), %lld dropped", stats.written, stats.files, stats.dropped);
+    }
+    UnloadSceneLayers();
+    UnloadTextCache();
+    UnloadParticles();
+    UnloadPostProcess();
+    SetProfilerEnabled(false);
+    UpdateProfileBatch();
+    if (profileBatchLoaded) rlUnloadRenderBatch(profileBatch);
+    UnloadGameAudio();
+    CloseAssetPack();
     CloseAudioDevice();
     CloseWindow();
     
     return 0;
 }
 
-void ResetBall(int direction) // direction: 0 = random, 1 = to player, -1 = to computer
+static void UpdateGameplayTick(unsigned int input)
+{
+    prevBallPosition = (Vector2){ sim.ball.x, sim.ball.y };
+    prevPlayerPaddleY = sim.playerPaddle.y;
+    prevComputerPaddleY = sim.computerPaddle.y;
+    if (sim.extraBalls.count > 0) {
+        memcpy(prevExtraBallX, sim.extraBalls.x, sim.extraBalls.count * sizeof(float));
+        memcpy(prevExtraBallY, sim.extraBalls.y, sim.extraBalls.count * sizeof(float));
+    }
+
+    {
+        ProfileScope profile(PROFILE_SIM);
+        StepPongSim(&sim, input);
+    }
+    if (!replayActive && !benchMode) {
+        RecordReplayTick(&recording, input);
+        recordingUnsaved = true;
+    }
+    HandleTickEvents();
+
+    // Check for game over
+    if (sim.matchOver) {
+        currentState = GAME_OVER;
+        if (sim.computerScore > sim.playerScore) QueueSound(SFX_GAME_LOST, 1.0f, 1.0f, 0.5f);
+        SaveRecording();
+        EndMatchTelemetry(false);
+    }
+}
+
+static void HandleTickEvents(void)
+{
+    // Fast-forward runs hundreds of ticks a frame, too many to be worth sounds and shake
+    HandleSimEvents(sim.events, (replayActive && replayFast) ? 0 : sim.eventCount);
+}
+
+static void HandleSimEvents(const SimEvent *events, int eventCount)
+{
+    for (int i = 0; i < eventCount; i++) {
+        const SimEvent &event = events[i];
+        if (telemetryActive && !replayActive && !netplayActive) LogEventTelemetry(event);
+        float pan = 1.0f - event.x / SCREEN_WIDTH;  // Sounds follow the ball across the stereo field, 1.0 is left
+        switch (event.type) {
+            case SIM_EVENT_WALL_HIT:
+                QueueSound(SFX_WALL_HIT, 1.0f, 1.0f, pan);
+                SpawnParticles(PARTICLE_DUST, event.x, event.y, 0.0f, LIGHTGRAY, &fxRng);
+                break;
+            case SIM_EVENT_PADDLE_HIT:
+                // Faster returns ring a little higher
+                QueueSound(SFX_PADDLE_HIT, 1.0f, 0.9f + 0.3f * fabsf(event.speedX) / sim.params.maxSpeed, pan);
+                // Sparks fly back into the court off the paddle face
+                SpawnParticles(PARTICLE_SPARKS, event.x, event.y, (event.side == SIDE_PLAYER) ? 1.0f : -1.0f,
+                               (event.side == SIDE_PLAYER) ? GOLD : ORANGE, &fxRng);
+                break;
+            case SIM_EVENT_OBSTACLE_HIT: {
+                const Obstacle &obstacle = GetLevel(sim.level)->obstacles[event.obstacle];
+                if (obstacle.type == OBSTACLE_BRICK) {
+                    QueueSound(SFX_WALL_HIT, 1.0f, 1.3f, pan);
+                    SpawnParticles(PARTICLE_DUST, event.x, event.y, 0.0f, SKYBLUE, &fxRng);
+                } else {
+                    QueueSound(SFX_PADDLE_HIT, 0.8f, 0.7f, pan);
+                    SpawnParticles(PARTICLE_SPARKS, event.x, event.y, (event.speedX > 0.0f) ? 1.0f : -1.0f,
+                                   (obstacle.type == OBSTACLE_BUMPER) ? MAGENTA : LIGHTGRAY, &fxRng);
+                }
+            } break;
+            case SIM_EVENT_SCORE:
+                SpawnParticles(PARTICLE_BURST, event.x, event.y, 0.0f, (event.side == SIDE_PLAYER) ? SKYBLUE : RED, &fxRng);
+                screenShake = 8.0f; // Trigger screen shake
+                QueueSound(SFX_SCORE, 1.0f, 1.0f, pan);
+                // The ball teleports on a serve, so don't interpolate from its old position or trail it
+                prevBallPosition = (Vector2){ sim.ball.x, sim.ball.y };
+                trailCount = 0;
+                break;
+        }
+    }
+}
+
+static void UpdateThreadedSim(void)
+{
+    bool live = (currentState == GAMEPLAY) && !replayActive && !netplayActive && !benchMode;
+    if (live && !sim.matchOver && !IsSimThreadRunning()) {
+        SetSimThreadInput(frameInput);
+        StartSimThread(&sim, &recording);
+        simSnapshotTime = GetSimThreadTime();
+    }
+
+    if (IsSimThreadRunning()) {
+        TakeSimSnapshot();
+        if (!live || sim.matchOver) StopThreadedSim();
+    }
+
+    // Same ending as UpdateGameplayTick(), once the thread has let go of the recording
+    if (live && sim.matchOver) {
+        currentState = GAME_OVER;
+        if (sim.computerScore > sim.playerScore) QueueSound(SFX_GAME_LOST, 1.0f, 1.0f, 0.5f);
+        SaveRecording();
+        EndMatchTelemetry(false);
+    }
+
+    // The accumulator only drives interpolation here, as the time since the rendered tick ran
+    if (IsSimThreadRunning()) {
+        tickAccumulator = (float)(GetSimThreadTime() - simSnapshotTime);
+        if (tickAccumulator < 0.0f) tickAccumulator = 0.0f;
+        if (tickAccumulator > SIM_DT) tickAccumulator = SIM_DT;
+    }
+}
+
+static void TakeSimSnapshot(void)
+{
+    const SimSnapshot *snapshot = AcquireSimSnapshot();
+    if (snapshot == NULL) return;
+
+    sim = snapshot->sim;
+    prevBallPosition = (Vector2){ snapshot->prevBallX, snapshot->prevBallY };
+    prevPlayerPaddleY = snapshot->prevPlayerPaddleY;
+    prevComputerPaddleY = snapshot->prevComputerPaddleY;
+    if (sim.extraBalls.count > 0) {
+        memcpy(prevExtraBallX, snapshot->prevExtraBallX, sim.extraBalls.count * sizeof(float));
+        memcpy(prevExtraBallY, snapshot->prevExtraBallY, sim.extraBalls.count * sizeof(float));
+    }
+    simSnapshotTime = snapshot->tickTime;
+    recordingUnsaved = true;
+    HandleSimEvents(snapshot->events, snapshot->eventCount);
+}
+
+static void StopThreadedSim(void)
+{
+    if (!IsSimThreadRunning()) return;
+    StopSimThread();
+    TakeSimSnapshot();      // Ticks that ran since the frame's snapshot
+}
+
+static void LogEventTelemetry(const SimEvent &event)
+{
+    // Indexed by SimEventType
+    static const TelemetryEventType types[] = {
+        TELEMETRY_WALL_HIT, TELEMETRY_PADDLE_HIT, TELEMETRY_SCORE, TELEMETRY_OBSTACLE_HIT
+    };
+    uint8_t online = netplayActive ? TELEMETRY_ONLINE : 0;
+
+    TelemetryEvent entry = { 0 };
+    entry.difficulty = (uint8_t)sim.difficulty;
+    if (!telemetryMatchOpen) {
+        telemetryMatchOpen = true;
+        entry.type = TELEMETRY_MATCH_START;
+        entry.flags = online;
+        entry.tick = event.tick;
+        entry.x = (float)sim.playerScore;
+        entry.y = (float)sim.computerScore;
+        PushTelemetry(&entry);
+    }
+
+    entry.type = (uint8_t)types[event.type];
+    entry.side = (uint8_t)event.side;
+    entry.flags = online | (event.speedClamped ? TELEMETRY_SPEED_CLAMPED : 0);
+    entry.tick = event.tick;
+    entry.x = event.x;
+    entry.y = event.y;
+    entry.speedX = event.speedX;
+    entry.speedY = event.speedY;
+    entry.hitPosition = event.hitPosition;
+    PushTelemetry(&entry);
+}
+
+static void LogNetplayTelemetry(void)
+{
+    const SimEvent *events;
+    int eventCount;
+    while (TakeNetplayConfirmedEvents(&netplay, &events, &eventCount)) {
+        if (!telemetryActive) continue;
+        for (int i = 0; i < eventCount; i++) LogEventTelemetry(events[i]);
+    }
+}
+
+static void EndMatchTelemetry(bool abandoned)
+{
+    if (!telemetryMatchOpen) return;
+    telemetryMatchOpen = false;
+
+    TelemetryEvent entry = { 0 };
+    entry.type = TELEMETRY_MATCH_END;
+    entry.side = (uint8_t)((sim.playerScore >= sim.computerScore) ? SIDE_PLAYER : SIDE_COMPUTER);
+    entry.difficulty = (uint8_t)sim.difficulty;
+    entry.flags = (abandoned ? TELEMETRY_ABANDONED : 0) | (netplayActive ? TELEMETRY_ONLINE : 0);
+    entry.tick = sim.tick;
+    entry.x = (float)sim.playerScore;
+    entry.y = (float)sim.computerScore;
+    PushTelemetry(&entry);
+}
+
+static void UpdateNetplay(unsigned int input, float frameTime)
+{
+    NetplayState state = PollNetplay(&netplay, &sim, GetTime());
+    if (state == NETPLAY_DISCONNECTED) {
+        TraceLog(LOG_WARNING, "NETPLAY: Opponent disconnected");
+        StopNetplay();
+        currentState = MAIN_MENU;
+        return;
+    }
+    if (state != NETPLAY_RUNNING) {
+        SnapInterpolation();
+        return;
+    }
+
+    // Sounds and particles come from a tick's first run, re-simulated ticks stay silent. Telemetry
+    // waits until a tick can't be rolled back. A tick held back for the peer still uses up its
+    // time, that's how the side running ahead slows down
+    LogNetplayTelemetry();
+    tickAccumulator += frameTime;
+    while (tickAccumulator >= SIM_DT) {
+        SnapInterpolation();
+        bool advanced;
+        {
+            ProfileScope profile(PROFILE_SIM);     // Includes re-simulating rolled back ticks
+            advanced = AdvanceNetplay(&netplay, &sim, input, GetTime());
+        }
+        if (advanced) {
+            HandleTickEvents();
+            LogNetplayTelemetry();
+        }
+        tickAccumulator -= SIM_DT;
+    }
+
+    // A point scored on a predicted input might still be rolled back, so wait for confirmation
+    if (sim.matchOver && IsNetplayConfirmed(&netplay)) {
+        currentState = GAME_OVER;
+        CourtSide remoteSide = (netplay.localSide == SIDE_PLAYER) ? SIDE_COMPUTER : SIDE_PLAYER;
+        int localScore = (remoteSide == SIDE_COMPUTER) ? sim.playerScore : sim.computerScore;
+        int remoteScore = (remoteSide == SIDE_COMPUTER) ? sim.computerScore : sim.playerScore;
+        if (remoteScore > localScore) QueueSound(SFX_GAME_LOST, 1.0f, 1.0f, 0.5f);
+        EndMatchTelemetry(false);
+    }
+}
+
+static void StartNetplay(int hostPort, const char *joinAddress, DifficultyLevel difficulty, NetConditions conditions)
+{
+    SaveRecording();
+    replayActive = false;
+
+    bool started = (joinAddress != NULL) ? JoinNetplay(&netplay, joinAddress) :
+        HostNetplay(&netplay, hostPort, difficulty, NewMatchSeed(), multiBall ? MULTIBALL_EXTRA_BALLS : 0, courtLevel);
+    if (!started) {
+        TraceLog(LOG_WARNING, "NETPLAY: Could not %s", (joinAddress != NULL) ? TextFormat("reach %s", joinAddress) : TextFormat("listen on port %d", hostPort));
+        return;
+    }
+    SetNetplayConditions(&netplay, conditions);
+
+    netplayActive = true;
+    currentState = GAMEPLAY;
+    ClearParticles();
+    SnapInterpolation();
+}
+
+static void StopNetplay(void)
+{
+    if (!netplayActive) return;
+    CloseNetplay(&netplay);
+    netplayActive = false;
+}
+
+static void RunRenderBenchmark(int frames)
+{
+    static const GameState states[] = { MAIN_MENU, DIFFICULTY_SELECT, READY_TO_START, GAMEPLAY, PAUSED, GAME_OVER };
+    static const char *names[] = { "main_menu", "difficulty_select", "ready_to_start", "gameplay", "paused", "game_over" };
+    benchMode = true;
+    SetTargetFPS(0);
+
+    for (int s = 0; s < (int)(sizeof(states) / sizeof(states[0])); s++) {
+        // A fixed seed and AI on both paddles, so every run draws the same rallies
+        InitPongSim(&sim, HARD, 1);
+        sim.controllers[SIDE_PLAYER] = CONTROLLER_AI;
+        if (states[s] == GAME_OVER) {
+            sim.playerScore = WINNING_SCORE;
+            sim.computerScore = WINNING_SCORE - 3;
+            sim.matchOver = true;
+        }
+        ClearParticles();
+        SnapInterpolation();
+
+        double start = 0.0;
+        for (int frame = -BENCH_WARMUP_FRAMES; frame < frames; frame++) {
+            if (frame == 0) start = GetTime();
+            if (states[s] == GAMEPLAY && sim.matchOver) StartPongSimMatch(&sim, sim.seed + 1);
+            currentState = states[s];
+            UpdateDrawFrame();
+        }
+        double seconds = GetTime() - start;
+
+        printf("BENCH %-28s %10.1f fps\n", TextFormat("render.%s", names[s]), (seconds > 0) ? frames / seconds : 0.0);
+        fflush(stdout);
+    }
+}
+
+static void ApplyFramePacing(void)
+{
+#if !defined(PLATFORM_WEB)
+    // requestAnimationFrame paces the web build, there's nothing to choose there
+    int refreshRate = GetMonitorRefreshRate(GetCurrentMonitor());
+    if (lowLatency) ClearWindowState(FLAG_VSYNC_HINT);
+    else SetWindowState(FLAG_VSYNC_HINT);
+    pacedFps = (refreshRate > 0) ? refreshRate : 60;
+    SetTargetFPS(pacedFps);
+#endif
+}
+
+static void UpdatePresentRate(void)
+{
+    // Nothing else reads GetKeyPressed(), so its queue is free to drain as an any-key check
+    bool input = false;
+    while (GetKeyPressed() != 0) input = true;
+    Vector2 mouseDelta = GetMouseDelta();
+    if (input || mouseDelta.x != 0 || mouseDelta.y != 0 || GetMouseWheelMove() != 0 || IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
+        lastInputTime = GetTime();
+    }
+
+    // Gameplay auto-pauses on focus loss, so only an online match keeps full rate in the background
+    PresentRate rate = PRESENT_IDLE;
+    if (currentState == GAMEPLAY || netplayActive || latencyTest || IsProfilerEnabled() ||
+        GetTime() - lastInputTime < IDLE_INPUT_HOLD) rate = PRESENT_FULL;
+    else if (!IsWindowFocused() || IsWindowMinimized() || IsWindowHidden()) rate = PRESENT_ASLEEP;
+    if (rate == presentRate) return;
+    presentRate = rate;
+
+#if defined(PLATFORM_WEB)
+    // Browsers already stop requestAnimationFrame in hidden tabs, asleep is a slow poll for the focus coming back
+    static const int animationFrameIntervals[] = { 1, 60 / IDLE_FPS, 15 };
+    emscripten_set_main_loop_timing(EM_TIMING_RAF, animationFrameIntervals[rate]);
+#else
+    // With event waiting on, EndDrawing() blocks until the window gets an event
+    if (rate == PRESENT_ASLEEP) EnableEventWaiting();
+    else DisableEventWaiting();
+    if (rate == PRESENT_FULL) ApplyFramePacing();
+    else SetTargetFPS(IDLE_FPS);
+#endif
+}
+
+static float LeadPaddleY(const Paddle &paddle, unsigned int input, float tickAlpha)
+{
+    // The next tick's position is known exactly, a human paddle only depends on its input
+    Paddle next = paddle;
+    StepHumanPaddle(&next, (input & INPUT_PLAYER_UP) != 0, (input & INPUT_PLAYER_DOWN) != 0);
+    return paddle.y + (next.y - paddle.y) * tickAlpha;
+}
+
+static void RecordLatencySample(double presentTime)
+{
+    // Measured from the poll, a key pressed mid-frame waited on average another half frame before it
+    latencyLastMs = (float)((presentTime - frameStartTime) * 1000.0);
+    latencySamples++;
+    latencyAverageMs += (latencyLastMs - latencyAverageMs) / latencySamples;
+    TraceLog(LOG_INFO, "LATENCY: %.1f ms input to present (%s), average %.1f ms over %d presses",
+             latencyLastMs, lowLatency ? "low latency" : "vsync", latencyAverageMs, latencySamples);
+}
+
+static const char *GetSideName(CourtSide side)
+{
+    if (!netplayActive) return (side == SIDE_PLAYER) ? playerName : "COMPUTER";
+    return (side == netplay.localSide) ? playerName : "OPPONENT";
+}
+
+static void StartMatch(DifficultyLevel difficulty)
+{
+    StopThreadedSim();
+    StopNetplay();
+    EndMatchTelemetry(true);
+    SaveRecording();
+    replayActive = false;
+    InitPongSim(&sim, difficulty, NewMatchSeed());
+    BeginReplayRecording(&recording, sim.seed, difficulty);
+    ApplyLevel();
+    ApplyMultiBall();
+    ClearParticles();
+}
+
+static void ApplyMultiBall(void)
+{
+    SetPongSimExtraBalls(&sim, multiBall ? MULTIBALL_EXTRA_BALLS : 0);
+    recording.extraBalls = sim.extraBalls.count;
+    SnapInterpolation();
+}
+
+static void ApplyLevel(void)
+{
+    SetPongSimLevel(&sim, courtLevel);
+    recording.level = courtLevel;
+    SnapInterpolation();
+}
+
+static void SaveRecording(void)
+{
+    if (!recordingUnsaved) return;
+    recordingUnsaved = false;
+#if !defined(PLATFORM_WEB)
+    // Named by seed so every match keeps its own file
+    const char *fileName = TextFormat("pong_%016llx.rpl", (unsigned long long)recording.seed);
+    if (SaveReplay(&recording, fileName)) TraceLog(LOG_INFO, "REPLAY: Saved %d ticks to %s", recording.tickCount, fileName);
+    else TraceLog(LOG_WARNING, "REPLAY: Could not save %s", fileName);
+#endif
+}
+
+static void LoadSceneLayers(void)
+{
+    // The court never changes, draw it once into a texture
+    courtTexture = LoadRenderTexture(SCREEN_WIDTH, SCREEN_HEIGHT);
+    BeginTextureMode(courtTexture);
+        ClearBackground(BLANK);
+        // Draw court border
+        DrawRectangleLinesEx((Rectangle){COURT_X, COURT_Y, COURT_WIDTH, COURT_HEIGHT}, 2, DARKGRAY);
+
+        // Draw center line (within court boundaries)
+        float centerX = COURT_X + COURT_WIDTH / 2;
+        for (int i = COURT_Y + 10; i < COURT_Y + COURT_HEIGHT - 10; i += 30) {
+            DrawRectangle(centerX - 2, i, 4, 15, DARKGRAY);
+        }
+    EndTextureMode();
+
+    Image starImage = GenImageGradientRadial(32, 32, 0.5f, WHITE, BLANK);
+    starTexture = LoadTextureFromImage(starImage);
+    UnloadImage(starImage);
+    SetTextureFilter(starTexture, TEXTURE_FILTER_BILINEAR);
+
+    Image ballImage = GenImageGradientRadial(32, 32, 0.85f, WHITE, BLANK);
+    ballTexture = LoadTextureFromImage(ballImage);
+    UnloadImage(ballImage);
+    SetTextureFilter(ballTexture, TEXTURE_FILTER_BILINEAR);
+
+    starShaderLoaded = LoadFragmentShader(TextFormat("resources/shaders/glsl%i/stars.fs", GLSL_VERSION), &starShader);
+    if (starShaderLoaded) starTimeLoc = GetShaderLocation(starShader, "time");
+}
+
+static bool LoadFragmentShader(const char *fileName, Shader *shader)
+{
+    // Pack entries are NUL terminated, so shader source is usable in place
+    const unsigned char *source = GetAssetData(fileName, NULL);
+    if (source != NULL) *shader = LoadShaderFromMemory(NULL, (const char *)source);
+    else if (FileExists(fileName)) *shader = LoadShader(0, fileName);
+    else return false;
+
+    // raylib falls back to its default shader when compilation fails
+    return shader->id != rlGetShaderIdDefault();
+}
+
+static void UnloadSceneLayers(void)
+{
+    if (starShaderLoaded) UnloadShader(starShader);
+    UnloadTexture(starTexture);
+    UnloadTexture(ballTexture);
+    UnloadRenderTexture(courtTexture);
+}
+
+static void DrawStarfield(bool twinkle)
+{
+    bool gpuTwinkle = twinkle && starShaderLoaded;
+    if (gpuTwinkle) {
+        float time = (float)fmod(GetTime(), PI);   // sin(time*2) repeats every PI seconds, keep float precision
+        SetShaderValue(starShader, starTimeLoc, &time, SHADER_UNIFORM_FLOAT);
+        CountBatchedDraws();
+        BeginShaderMode(starShader);
+    }
+
+    rlCheckRenderBatchLimit(4 * numStars);
+    rlSetTexture(starTexture.id);
+    rlBegin(RL_QUADS);
+    for (int i = 0; i < numStars; i++) {
+        float starSize = 1.5f;
+        Color starColor = GRAY;
+        if (twinkle) {
+            // Menu stars with color variations
+            starSize = (i % 4 == 0) ? 3.0f : ((i % 3 == 0) ? 2.0f : 1.2f);
+            starColor = (i % 5 == 0) ? YELLOW : ((i % 7 == 0) ? SKYBLUE : WHITE);
+            if (gpuTwinkle) starColor.a = (unsigned char)(fmodf((float)i, 2*PI) / (2*PI) * 255.0f);
+            else starColor = ColorAlpha(starColor, 0.7f + 0.3f * sinf(GetTime() * 2 + i));
+        }
+
+        float half = starSize * STAR_SPRITE_SCALE;
+        rlColor4ub(starColor.r, starColor.g, starColor.b, starColor.a);
+        rlTexCoord2f(0.0f, 0.0f); rlVertex2f(stars[i].x - half, stars[i].y - half);
+        rlTexCoord2f(0.0f, 1.0f); rlVertex2f(stars[i].x - half, stars[i].y + half);
+        rlTexCoord2f(1.0f, 1.0f); rlVertex2f(stars[i].x + half, stars[i].y + half);
+        rlTexCoord2f(1.0f, 0.0f); rlVertex2f(stars[i].x + half, stars[i].y - half);
+    }
+    rlEnd();
+    rlSetTexture(0);
+
+    if (gpuTwinkle) {
+        CountBatchedDraws();
+        EndShaderMode();
+    }
+}
+
+static void DrawExtraBalls(float tickAlpha)
 {
-    ball.x = (float)COURT_X + COURT_WIDTH / 2;
-    ball.y = (float)COURT_Y + COURT_HEIGHT / 2;
-    ball.hitCounter = 0;
-    ball.impossibleSpeedMultiplier = 1.0f;    float initialSpeed = 0;
-    switch(currentDifficulty) {
-        case EASY: initialSpeed = 7.0f; break;     // Reduced for more manageable gameplay
-        case MEDIUM: initialSpeed = 10.0f; break;  // Adjusted for proper medium challenge
-        case HARD: initialSpeed = 14.0f; break;    // Adjusted for better game feel
-        case IMPOSSIBLE: initialSpeed = 18.0f; break;  // Still challenging but more reasonable
+    const BallSet &balls = sim.extraBalls;
+    if (balls.count == 0) return;
+
+    const Color tints[3] = { WHITE, SKYBLUE, GOLD };
+    rlCheckRenderBatchLimit(4 * balls.count);
+    rlSetTexture(ballTexture.id);
+    rlBegin(RL_QUADS);
+    for (int i = 0; i < balls.count; i++) {
+        // A re-served ball jumps to the center, draw it there rather than sweeping across the court
+        float x = balls.x[i], y = balls.y[i];
+        if (fabsf(x - prevExtraBallX[i]) < COURT_WIDTH / 4) {
+            x = prevExtraBallX[i] + (x - prevExtraBallX[i]) * tickAlpha;
+            y = prevExtraBallY[i] + (y - prevExtraBallY[i]) * tickAlpha;
+        }
+
+        float half = balls.radius[i] * 1.15f;  // The sprite's edge fades out over its last 15%
+        Color tint = tints[i % 3];
+        rlColor4ub(tint.r, tint.g, tint.b, 230);
+        rlTexCoord2f(0.0f, 0.0f); rlVertex2f(x - half, y - half);
+        rlTexCoord2f(0.0f, 1.0f); rlVertex2f(x - half, y + half);
+        rlTexCoord2f(1.0f, 1.0f); rlVertex2f(x + half, y + half);
+        rlTexCoord2f(1.0f, 0.0f); rlVertex2f(x + half, y - half);
     }
+    rlEnd();
+    rlSetTexture(0);
+}
+
+static void DrawLevel(float tick)
+{
+    const Level *level = GetLevel(sim.level);
+    if (level->obstacleCount == 0) return;
+
+    // Mosaic's thousand-odd bricks are too many quads for one batch check on the web, so the
+    // batch is checked every LEVEL_DRAW_CHUNK quads and flushes only when it is actually full
+    const Color colors[3] = { SKYBLUE, MAGENTA, LIGHTGRAY };
+    rlSetTexture(rlGetTextureIdDefault());
+    for (int first = 0; first < level->obstacleCount; first += LEVEL_DRAW_CHUNK) {
+        int last = (first + LEVEL_DRAW_CHUNK < level->obstacleCount) ? first + LEVEL_DRAW_CHUNK : level->obstacleCount;
+        rlCheckRenderBatchLimit(4 * (last - first));
+        rlBegin(RL_QUADS);
+        rlTexCoord2f(0.0f, 0.0f);
+        for (int i = first; i < last; i++) {
+            const Obstacle &obstacle = level->obstacles[i];
+            if (obstacle.type == OBSTACLE_BRICK && (sim.brokenBricks[i >> 5] & (1u << (i & 31)))) continue;
+
+            float x = obstacle.x, y = GetObstacleY(&obstacle, tick);
+            Color color = colors[obstacle.type];
+            rlColor4ub(color.r, color.g, color.b, 220);
+            rlVertex2f(x, y);
+            rlVertex2f(x, y + obstacle.height);
+            rlVertex2f(x + obstacle.width, y + obstacle.height);
+            rlVertex2f(x + obstacle.width, y);
+        }
+        rlEnd();
+    }
+    rlSetTexture(0);
+}
 
-    if (direction == 0) {
-        ball.speedX = (GetRandomValue(0, 1) == 0) ? -initialSpeed : initialSpeed;
+static void DrawBallTrail(float radius)
+{
+    if (trailCount < 2) return;
+
+    // One pass from the newest sample to the oldest. Each sample gets two edge points across the
+    // path, as wide as the ball at the head and narrowing to nothing at the tail, and neighbouring
+    // samples are joined by a quad. rlgl has no strip primitive, but quads sharing their edges
+    // draw the same strip in the same single batch
+    rlCheckRenderBatchLimit(4 * (trailCount - 1));
+    rlSetTexture(rlGetTextureIdDefault());
+    rlBegin(RL_QUADS);
+    rlTexCoord2f(0.0f, 0.0f);
+    Vector2 normal = { 0.0f, 1.0f };
+    Vector2 newerLeft = { 0 }, newerRight = { 0 };
+    unsigned char newerAlpha = 0;
+    for (int i = 0; i < trailCount; i++) {
+        Vector2 point = ballTrail[(trailIndex - 1 - i + trailLength) % trailLength];
+        Vector2 newer = ballTrail[(trailIndex - 1 - ((i > 0) ? i - 1 : i) + trailLength) % trailLength];
+        Vector2 older = ballTrail[(trailIndex - 1 - ((i < trailCount - 1) ? i + 1 : i) + trailLength) % trailLength];
+
+        // Across the direction of travel at this sample, kept from the last sample while the ball is still
+        float dx = newer.x - older.x, dy = newer.y - older.y;
+        float length = sqrtf(dx*dx + dy*dy);
+        if (length > 0.001f) normal = (Vector2){ -dy / length, dx / length };
+
+        float taper = 1.0f - (float)i / (trailCount - 1);
+        float halfWidth = radius * taper;
+        unsigned char alpha = (unsigned char)(77.0f * taper);      // 30% at the head
+        Vector2 left = { point.x + normal.x * halfWidth, point.y + normal.y * halfWidth };
+        Vector2 right = { point.x - normal.x * halfWidth, point.y - normal.y * halfWidth };
+
+        if (i > 0) {
+            // Same winding as the sprite quads, so backface culling keeps it
+            rlColor4ub(255, 255, 255, alpha);
+            rlVertex2f(right.x, right.y);
+            rlVertex2f(left.x, left.y);
+            rlColor4ub(255, 255, 255, newerAlpha);
+            rlVertex2f(newerLeft.x, newerLeft.y);
+            rlVertex2f(newerRight.x, newerRight.y);
+        }
+        newerLeft = left;
+        newerRight = right;
+        newerAlpha = alpha;
+    }
+    rlEnd();
+    rlSetTexture(0);
+}
+
+static void DrawParticleLayer(void)
+{
+    CountBatchedDraws();
+    int quads = DrawParticles(profileBatchActive ? &profileBatch : NULL);
+    if (profileBatchActive && quads > 0) {
+        frameDrawCalls += (quads + PARTICLE_BATCH_QUADS - 1) / PARTICLE_BATCH_QUADS;
+        frameVertices += 4 * quads;
+    }
+}
+
+static void LoadPostProcess(void)
+{
+    postShaderLoaded = LoadFragmentShader(TextFormat("resources/shaders/glsl%i/postfx.fs", GLSL_VERSION), &postShader);
+    if (postShaderLoaded) {
+        postResolutionLoc = GetShaderLocation(postShader, "resolution");
+        postShakeLoc = GetShaderLocation(postShader, "shakeOffset");
+        postScanlinesLoc = GetShaderLocation(postShader, "scanlines");
+        postBloomLoc = GetShaderLocation(postShader, "bloom");
+
+        // The pass shades window pixels, so effects are sized in canvas pixels whatever the render scale
+        float resolution[2] = { (float)SCREEN_WIDTH, (float)SCREEN_HEIGHT };
+        SetShaderValue(postShader, postResolutionLoc, resolution, SHADER_UNIFORM_VEC2);
+    }
+    UpdatePresentRect();
+    ResizeSceneTarget();
+}
+
+static void UnloadPostProcess(void)
+{
+    UnloadRenderTexture(sceneTarget);
+    if (postShaderLoaded) UnloadShader(postShader);
+}
+
+static void UpdatePresentRect(void)
+{
+    // Largest whole-pixel fit that keeps the aspect, centered, bars on the other axis
+    float fit = fminf((float)GetScreenWidth() / SCREEN_WIDTH, (float)GetScreenHeight() / SCREEN_HEIGHT);
+    float width = floorf(SCREEN_WIDTH * fit), height = floorf(SCREEN_HEIGHT * fit);
+    if (width < 1 || height < 1) return;    // Minimized
+    presentRect = (Rectangle){ floorf((GetScreenWidth() - width) / 2), floorf((GetScreenHeight() - height) / 2), width, height };
+
+    // GetMousePosition() is (position + offset) * scale, so every menu keeps working in canvas coordinates
+    SetMouseOffset(-(int)presentRect.x, -(int)presentRect.y);
+    SetMouseScale(SCREEN_WIDTH / width, SCREEN_HEIGHT / height);
+}
+
+static void UpdateRenderScale(float frameTime, float workTime)
+{
+    // Never render more pixels than the window shows, and only on the step grid so resizes are rare
+    float fit = fminf(presentRect.width / SCREEN_WIDTH, RENDER_SCALE_MAX);
+    float maxScale = RENDER_SCALE_MIN + floorf((fit - RENDER_SCALE_MIN) / RENDER_SCALE_STEP + 0.001f) * RENDER_SCALE_STEP;
+    if (maxScale < RENDER_SCALE_MIN) maxScale = RENDER_SCALE_MIN;
+    if (fixedRenderScale > 0.0f) {
+        renderScale = fixedRenderScale;
+        return;
+    }
+    if (renderScale > maxScale) renderScale = maxScale;
+
+    // Idle frames are slow on purpose and say nothing about the GPU
+    if (presentRate != PRESENT_FULL) {
+        dynresFrames = 0;
+        dynresTime = 0.0f;
+        dynresWork = 0.0f;
+        return;
+    }
+    dynresTime += frameTime;
+    dynresWork += workTime;
+    if (++dynresFrames < DYNRES_WINDOW) return;
+    float average = dynresTime / dynresFrames;
+    float averageWork = dynresWork / dynresFrames;
+    dynresFrames = 0;
+    dynresTime = 0.0f;
+    dynresWork = 0.0f;
+
+    // raylib has no GPU timer queries, but a fill-rate bound frame shows up as missed refreshes. The
+    // average frame time against the refresh interval tells whether the GPU kept up. Paced frames sit at
+    // the interval whatever the load, so headroom is judged from the work time, which leaves out the
+    // swap, the vsync wait and the limiter sleep. With a few frames in flight a GPU that falls behind
+    // stalls the next frame's draw calls, so the work time grows with the GPU's load too
+    int refreshRate = GetMonitorRefreshRate(GetCurrentMonitor());
+    float budget = 1.0f / ((refreshRate > 0) ? refreshRate : 60);
+    bool over = average > budget * 1.15f;
+    if (dynresProbing) {
+        // A step up that didn't hold waits twice as long before the next try, so the scale doesn't oscillate
+        dynresUpHold = over ? ((dynresUpHold * 2 < DYNRES_UP_HOLD_MAX) ? dynresUpHold * 2 : DYNRES_UP_HOLD_MAX) : DYNRES_UP_HOLD;
+        dynresProbing = false;
+    }
+    if (over) {
+        dynresHeadroom = 0;
+        if (renderScale > RENDER_SCALE_MIN) renderScale -= RENDER_SCALE_STEP;
+    } else if (averageWork < budget * DYNRES_WORK_HEADROOM) {
+        dynresHeadroom++;
     } else {
-        ball.speedX = initialSpeed * direction;
+        dynresHeadroom = 0;
+    }
+    if (dynresHeadroom >= dynresUpHold && renderScale < maxScale) {
+        renderScale += RENDER_SCALE_STEP;
+        dynresHeadroom = 0;
+        dynresProbing = true;
+    }
+}
+
+static void ResizeSceneTarget(void)
+{
+    int width = (int)(SCREEN_WIDTH * renderScale + 0.5f);
+    int height = (int)(SCREEN_HEIGHT * renderScale + 0.5f);
+    if (sceneTarget.id != 0 && sceneTarget.texture.width == width && sceneTarget.texture.height == height) return;
+
+    if (sceneTarget.id != 0) UnloadRenderTexture(sceneTarget);
+    sceneTarget = LoadRenderTexture(width, height);
+    SetTextureFilter(sceneTarget.texture, TEXTURE_FILTER_BILINEAR);
+}
+
+static void UpdateProfileBatch(void)
+{
+    if (IsProfilerEnabled() == profileBatchActive) return;
+    if (!profileBatchLoaded) {
+        profileBatch = rlLoadRenderBatch(1, PROFILE_BATCH_ELEMENTS);
+        profileBatchLoaded = true;
     }
-    ball.speedY = (GetRandomValue(0, 1) == 0) ? -initialSpeed : initialSpeed;
+    profileBatchActive = IsProfilerEnabled();
+    rlSetRenderBatchActive(profileBatchActive ? &profileBatch : NULL);
+}
+
+// rlgl keeps no draw statistics, so read the batch before each flush we trigger
+// Flushes rlgl does on its own when the batch fills up are missed, the counts are a lower bound
+static void CountBatchedDraws(void)
+{
+    if (!profileBatchActive) return;
+    for (int i = 0; i < profileBatch.drawCounter; i++) {
+        if (profileBatch.draws[i].vertexCount > 0) {
+            frameDrawCalls++;
+            frameVertices += profileBatch.draws[i].vertexCount;
+        }
+    }
+    rlDrawRenderBatchActive();
+}
+
+static void DrawProfilerOverlay(void)
+{
+    // Plain DrawText, these numbers change every frame and would only churn the text cache
+    ProfileStats stats = GetProfileStats();
+    int x = 10, y = 36;
+    DrawRectangle(x - 5, y - 5, 320, 70 + PROFILE_ZONE_COUNT * 12 + 70, ColorAlpha(BLACK, 0.75f));
+    DrawText(TextFormat("FRAME  min %.2f  avg %.2f  p99 %.2f ms", stats.minMs, stats.avgMs, stats.p99Ms), x, y, 10, WHITE);
+    y += 14;
+    DrawText(TextFormat("DRAW CALLS %d  VERTICES %d  SCALE %.3f", stats.drawCalls, stats.vertices, renderScale), x, y, 10, WHITE);
+    y += 18;
+    for (int z = 0; z < PROFILE_ZONE_COUNT; z++) {
+        DrawText(GetProfileZoneName((ProfileZone)z), x, y, 10, LIGHTGRAY);
+        DrawText(TextFormat("%.3f ms", stats.zoneMs[z]), x + 130, y, 10, LIGHTGRAY);
+        y += 12;
+    }
+
+    // Frame time graph, full height is 33.3 ms with a guide at 16.7 ms
+    static float frameMs[300];
+    int count = GetProfileFrameTimes(frameMs, 300);
+    int graphHeight = 60;
+    y += 6;
+    for (int i = 0; i < count; i++) {
+        float height = fminf(frameMs[i] / 33.3f, 1.0f) * graphHeight;
+        Color color = (frameMs[i] > 16.7f) ? RED : LIME;
+        DrawRectangle(x + i, y + graphHeight - (int)height, 1, (int)height, color);
+    }
+    DrawRectangle(x, y + graphHeight / 2, 300, 1, ColorAlpha(YELLOW, 0.6f));
+}
+
+static void DumpProfile(void)
+{
+    bool saved = SaveProfileCsv("profile.csv") && SaveProfileTrace("profile_trace.json");
+    if (!saved) {
+        TraceLog(LOG_WARNING, "PROFILER: Could not save profile.csv and profile_trace.json");
+        return;
+    }
+    TraceLog(LOG_INFO, "PROFILER: Saved profile.csv and profile_trace.json");
+#if defined(PLATFORM_WEB)
+    // Hand the files to the browser as downloads, raylib's shell.html provides the helper
+    emscripten_run_script("if (typeof saveFileFromMEMFSToDisk === 'function') {"
+                          " saveFileFromMEMFSToDisk('profile.csv', 'profile.csv');"
+                          " saveFileFromMEMFSToDisk('profile_trace.json', 'profile_trace.json'); }");
+#endif
+}
+
+static void SnapInterpolation(void)
+{
+    tickAccumulator = 0.0f;
+    prevBallPosition = (Vector2){ sim.ball.x, sim.ball.y };
+    prevPlayerPaddleY = sim.playerPaddle.y;
+    prevComputerPaddleY = sim.computerPaddle.y;
+    memcpy(prevExtraBallX, sim.extraBalls.x, sim.extraBalls.count * sizeof(float));
+    memcpy(prevExtraBallY, sim.extraBalls.y, sim.extraBalls.count * sizeof(float));
 }
 
 void UpdateDrawFrame(void)
 {    // Update
     //----------------------------------------------------------------------------------
+    frameStartTime = GetTime();
+    UpdatePresentRect();
+    if (IsKeyPressed(KEY_F3)) SetProfilerEnabled(!IsProfilerEnabled());
+    if (IsKeyPressed(KEY_F4)) DumpProfile();
+    if (IsKeyPressed(KEY_F5)) {
+        lowLatency = !lowLatency;
+        ApplyFramePacing();
+    }
+    if (IsKeyPressed(KEY_F6)) latencyTest = !latencyTest;
+    latencyFlash = latencyTest && (IsKeyPressed(KEY_W) || IsKeyPressed(KEY_S) || IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_DOWN));
+    BeginProfileFrame();
+    UpdateProfileBatch();
+    frameDrawCalls = 0;
+    frameVertices = 0;
+
     // Check if window lost focus and automatically pause the game
-    if (currentState == GAMEPLAY && !IsWindowFocused()) {
+    // Online matches can't pause, the peer's clock keeps running
+    if (currentState == GAMEPLAY && !IsWindowFocused() && !netplayActive && !benchMode) {
         currentState = PAUSED;
     }
+
+    // Real time elapsed since the last frame, all per-frame animation is scaled by it
+    float frameTime = benchMode ? BENCH_FRAME_TIME : GetFrameTime();
+    if (frameTime > MAX_FRAME_TIME) frameTime = MAX_FRAME_TIME;
     
-    // Update screen shake
+    // Update screen shake, the post-process pass applies it, or the camera when the shader is missing
+    Vector2 shakeOffset = { 0, 0 };
     if (screenShake > 0) {
-        camera.offset.x = GetRandomValue(-screenShake, screenShake);
-        camera.offset.y = GetRandomValue(-screenShake, screenShake);
-        screenShake -= 0.5f; // Reduce shake intensity
+        shakeOffset.x = RngRange(&fxRng, -(int)screenShake, (int)screenShake);
+        shakeOffset.y = RngRange(&fxRng, -(int)screenShake, (int)screenShake);
+        screenShake -= 30.0f * frameTime; // Reduce shake intensity
     } else {
         screenShake = 0;
-        camera.offset = (Vector2){ 0, 0 };
     }
     
-    // Update ball trail
-    ballTrail[trailIndex] = (Vector2){ ball.x, ball.y };
-    trailIndex = (trailIndex + 1) % TRAIL_LENGTH;
-    
+    bool inputProfiled = BeginProfileZone(PROFILE_INPUT);
     switch (currentState) {
         case MAIN_MENU: {
             // Handle name input
@@ -240,34 +1277,22 @@ void UpdateDrawFrame(void)
               // Check both keyboard and mouse selection for Easy difficulty
             if (IsKeyPressed(KEY_ONE) || IsKeyPressed(KEY_KP_1) || 
                 (mouseAction && CheckCollisionPointRec(mousePos, easyButton))) {
-                currentDifficulty = EASY;
-                computerPaddle.speed = 8.5f;
-                ResetBall(0);
-                playerScore = 0; computerScore = 0;
+                StartMatch(EASY);
                 currentState = READY_TO_START;
             }            // Check both keyboard and mouse selection for Medium difficulty
             else if (IsKeyPressed(KEY_TWO) || IsKeyPressed(KEY_KP_2) || 
                      (mouseAction && CheckCollisionPointRec(mousePos, mediumButton))) {
-                currentDifficulty = MEDIUM;
-                computerPaddle.speed = 12.0f;
-                ResetBall(0);
-                playerScore = 0; computerScore = 0;
+                StartMatch(MEDIUM);
                 currentState = READY_TO_START;
             }            // Check both keyboard and mouse selection for Hard difficulty
             else if (IsKeyPressed(KEY_THREE) || IsKeyPressed(KEY_KP_3) || 
                      (mouseAction && CheckCollisionPointRec(mousePos, hardButton))) {
-                currentDifficulty = HARD;
-                computerPaddle.speed = 15.0f;
-                ResetBall(0);
-                playerScore = 0; computerScore = 0;
+                StartMatch(HARD);
                 currentState = READY_TO_START;
             }            // Check both keyboard and mouse selection for Impossible difficulty
             else if (IsKeyPressed(KEY_FOUR) || IsKeyPressed(KEY_KP_4) || 
                      (mouseAction && CheckCollisionPointRec(mousePos, impossibleButton))) {
-                currentDifficulty = IMPOSSIBLE;
-                computerPaddle.speed = 24.0f;
-                ResetBall(0);
-                playerScore = 0; computerScore = 0;
+                StartMatch(IMPOSSIBLE);
                 currentState = READY_TO_START;
             }
             else if (IsKeyPressed(KEY_BACKSPACE)) {
@@ -278,286 +1303,96 @@ void UpdateDrawFrame(void)
         case READY_TO_START: {
             if (IsKeyPressed(KEY_SPACE)) {
                 currentState = GAMEPLAY;
+                QueueSound(SFX_GAME_START, 1.0f, 1.0f, 0.5f);
+            }
+            if (IsKeyPressed(KEY_B)) {
+                multiBall = !multiBall;
+                ApplyMultiBall();
+            }
+            if (IsKeyPressed(KEY_L)) {
+                courtLevel = (courtLevel + 1) % LEVEL_COUNT;
+                ApplyLevel();
             }
             break;
         }
         case GAMEPLAY: {
-            if (IsKeyPressed(KEY_SPACE)) {
+            if (IsKeyPressed(KEY_SPACE) && !netplayActive) {
                 currentState = PAUSED;
             }
             if (IsKeyPressed(KEY_M)) {
-                currentState = MAIN_MENU;            }            // --- Perfect Arcade Feel Player Paddle Control ---
-            const float acceleration = 7.0f;  // Very high acceleration for instant response
-            const float friction = 0.5f;      // Lower friction for precise control and faster stops
-            const float maxVelocity = 22.0f;  // Higher max velocity for lightning-fast movement
-            const float directionChangeBoost = 1.5f; // Extra boost when changing directions
-            
-            // Apply acceleration based on key press for extremely responsive control
-            if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) {
-                // Instant direction change with extra boost for arcade-perfect feel
-                if (playerPaddle.velocityY > 0) {
-                    playerPaddle.velocityY = -acceleration * directionChangeBoost; // Boosted immediate direction change
-                } else {
-                    playerPaddle.velocityY -= acceleration; // Direct acceleration for responsive control
-                }
-                
-                // Immediate boost to high speed for arcade feel
-                if (fabs(playerPaddle.velocityY) < maxVelocity * 0.5f) {
-                    playerPaddle.velocityY = -maxVelocity * 0.7f; // Quick ramp-up to 70% of max speed
+                currentState = MAIN_MENU;
+                StopThreadedSim();
+                SaveRecording();
+                replayActive = false;
+                StopNetplay();
+            }
+
+            if (replayActive && currentState == GAMEPLAY) {
+                // TAB toggles fast-forward, LEFT/RIGHT seek through snapshots
+                if (IsKeyPressed(KEY_TAB)) replayFast = !replayFast;
+                int seekTicks = 0;
+                if (IsKeyPressed(KEY_LEFT)) seekTicks = -REPLAY_SEEK_TICKS;
+                if (IsKeyPressed(KEY_RIGHT)) seekTicks = REPLAY_SEEK_TICKS;
+                if (seekTicks != 0) {
+                    SeekReplayPlayback(&playback, &sim, playback.tick + seekTicks);
+                    SnapInterpolation();
                 }
-            } else if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) {
-                // Instant direction change with extra boost for arcade-perfect feel
-                if (playerPaddle.velocityY < 0) {
-                    playerPaddle.velocityY = acceleration * directionChangeBoost; // Boosted immediate direction change
+
+                unsigned int input;
+                if (replayFast) {
+                    // Only the last tick of the frame gets drawn, the clock is checked every 64 ticks
+                    double budgetEnd = GetTime() + REPLAY_FAST_BUDGET;
+                    int ticksRun = 0;
+                    while (currentState == GAMEPLAY && NextReplayInput(&playback, &sim, &input)) {
+                        UpdateGameplayTick(input);
+                        if ((++ticksRun % 64) == 0 && GetTime() >= budgetEnd) break;
+                    }
+                    SnapInterpolation();
                 } else {
-                    playerPaddle.velocityY += acceleration; // Direct acceleration for responsive control
-                }
-                
-                // Immediate boost to high speed for arcade feel
-                if (fabs(playerPaddle.velocityY) < maxVelocity * 0.5f) {
-                    playerPaddle.velocityY = maxVelocity * 0.7f; // Quick ramp-up to 70% of max speed
+                    tickAccumulator += frameTime;
+                    while (tickAccumulator >= SIM_DT && currentState == GAMEPLAY &&
+                           NextReplayInput(&playback, &sim, &input)) {
+                        UpdateGameplayTick(input);
+                        tickAccumulator -= SIM_DT;
+                    }
                 }
-            } else {
-                // Apply stronger friction for crisp stops - arcade machines stop quickly
-                if (fabs(playerPaddle.velocityY) > 0.5f) {
-                    playerPaddle.velocityY *= friction;
-                } else {
-                    playerPaddle.velocityY = 0; // Complete stop when near zero for crisp feel
+
+                // An abandoned match ends with its recording rather than with a winner
+                if (sim.matchOver) currentState = GAME_OVER;
+                else if (playback.tick >= loadedReplay.tickCount) {
+                    currentState = MAIN_MENU;
+                    replayActive = false;
                 }
+                break;
             }
 
-            // Clamp velocity to max speed
-            if (playerPaddle.velocityY > maxVelocity) playerPaddle.velocityY = maxVelocity;
-            if (playerPaddle.velocityY < -maxVelocity) playerPaddle.velocityY = -maxVelocity;
-            
-            // Apply an aggressive deadzone to prevent tiny drifting movements
-            if (fabs(playerPaddle.velocityY) < 0.3f) playerPaddle.velocityY = 0;
-            
-            // Update paddle position based on velocity
-            playerPaddle.y += playerPaddle.velocityY;
+            // Held keys are sampled once per frame and applied to every tick run this frame
+            unsigned int input = 0;
+            if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) input |= INPUT_PLAYER_UP;
+            if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) input |= INPUT_PLAYER_DOWN;
+            frameInput = input;
 
-            // Keep paddle within court bounds and reset velocity on collision
-            if (playerPaddle.y < COURT_Y) {
-                playerPaddle.y = COURT_Y;
-                playerPaddle.velocityY = 0;
+            // On its own thread the simulation only needs the keys
+            if (IsSimThreadRunning()) {
+                SetSimThreadInput(input);
+                break;
             }
-            if (playerPaddle.y + playerPaddle.height > COURT_Y + COURT_HEIGHT) {
-                playerPaddle.y = COURT_Y + COURT_HEIGHT - playerPaddle.height;
-                playerPaddle.velocityY = 0;
+
+            // Online, the input drives whichever paddle this side plays
+            if (netplayActive) {
+                if (currentState == GAMEPLAY) UpdateNetplay(input, frameTime);
+                break;
             }
-            // --- End Smooth Player Paddle Control ---
-            
-            // Computer AI based on difficulty
-            {
-                float computerPaddleCenter = computerPaddle.y + computerPaddle.height / 2;
-                float ballTrackPosition = ball.y;
-                
-                // Adjust computer properties based on difficulty
-                float aiAccuracy = 0.0f; // Percentage chance of moving correctly
-                float aiReactionSpeed = 0.0f; // Speed multiplier
-                float aiDeadZone = 0.0f; // Area where paddle won't react
-                bool useAdvancedPrediction = false;
-                
-                // Set AI behavior based on difficulty
-                switch(currentDifficulty) {
-                    case EASY:
-                        aiAccuracy = 0.5f;
-                        aiReactionSpeed = 0.5f;
-                        aiDeadZone = 35.0f;
-                        useAdvancedPrediction = false;
-                        break;
-                    case MEDIUM:
-                        aiAccuracy = 0.65f;
-                        aiReactionSpeed = 0.55f;
-                        aiDeadZone = 40.0f;
-                        useAdvancedPrediction = false;
-                        break;
-                    case HARD:
-                        aiAccuracy = 0.75f;
-                        aiReactionSpeed = 0.75f;
-                        aiDeadZone = 30.0f;
-                        useAdvancedPrediction = false;
-                        break;
-                    case IMPOSSIBLE:
-                        aiAccuracy = 1.0f;
-                        aiReactionSpeed = 1.0f;
-                        aiDeadZone = 5.0f;
-                        useAdvancedPrediction = true;
-                        break;
-                }
-                
-                // Add prediction based on difficulty
-                if (ball.speedX > 0) {
-                    // Calculate where the ball will be when it reaches the computer's x position
-                    float timeToReach = (computerPaddle.x - ball.x) / ball.speedX;
-                    ballTrackPosition = ball.y + ball.speedY * timeToReach;
-                      // Keep the prediction within court bounds
-                    if (useAdvancedPrediction) {
-                        // Add prediction error for Hard mode to make it more human
-                        if (currentDifficulty == HARD) {
-                            ballTrackPosition += GetRandomValue(-20, 20);
-                        }
-
-                        // Account for ball radius when calculating bounce
-                        while (ballTrackPosition - ball.radius < COURT_Y || ballTrackPosition + ball.radius > COURT_Y + COURT_HEIGHT) {
-                            if (ballTrackPosition - ball.radius < COURT_Y) 
-                                ballTrackPosition = 2 * (COURT_Y + ball.radius) - ballTrackPosition;
-                            if (ballTrackPosition + ball.radius > COURT_Y + COURT_HEIGHT) 
-                                ballTrackPosition = 2 * (COURT_Y + COURT_HEIGHT - ball.radius) - ballTrackPosition;
-                        }
-                    }
-                }
-                
-                // Add difficulty-based movement
-                if (GetRandomValue(0, 100) < aiAccuracy * 100) {  // Chance to react based on accuracy
-                    if (computerPaddleCenter < ballTrackPosition - aiDeadZone) {
-                        computerPaddle.y += computerPaddle.speed * aiReactionSpeed;
-                    } else if (computerPaddleCenter > ballTrackPosition + aiDeadZone) {
-                        computerPaddle.y -= computerPaddle.speed * aiReactionSpeed;
-                    }
-                }                    // Keep computer paddle within court bounds
-                if (computerPaddle.y < COURT_Y) computerPaddle.y = COURT_Y;
-                if (computerPaddle.y + computerPaddle.height > COURT_Y + COURT_HEIGHT) {
-                    computerPaddle.y = COURT_Y + COURT_HEIGHT - computerPaddle.height;
-                }
-                
-                // Update ball position
-                ball.x += ball.speedX;
-                ball.y += ball.speedY;
-                  // Ball collision with top and bottom court boundaries
-                if (ball.y - ball.radius <= COURT_Y || ball.y + ball.radius >= COURT_Y + COURT_HEIGHT) {
-                    ball.speedY *= -1;
-                    // Keep ball within court after collision
-                    if (ball.y - ball.radius < COURT_Y) {
-                        ball.y = COURT_Y + ball.radius;
-                    }
-                    if (ball.y + ball.radius > COURT_Y + COURT_HEIGHT) {
-                        ball.y = COURT_Y + COURT_HEIGHT - ball.radius;
-                    }
-                    if (wallHit.frameCount > 0) PlaySound(wallHit);
-                }                // Ball collision with player paddle
-                if (ball.x - ball.radius <= playerPaddle.x + playerPaddle.width &&
-                    ball.y >= playerPaddle.y && ball.y <= playerPaddle.y + playerPaddle.height &&
-                    ball.speedX < 0) {
-                    
-                    // Track consecutive hits for IMPOSSIBLE difficulty
-                    ball.hitCounter++;
-                    
-                    // Update speed multiplier in IMPOSSIBLE mode
-                    if (currentDifficulty == IMPOSSIBLE && ball.hitCounter > 3) {
-                        ball.impossibleSpeedMultiplier += 0.05f; // Reduced from 0.08f for more gradual increase
-                        if (ball.impossibleSpeedMultiplier > 2.0f) ball.impossibleSpeedMultiplier = 2.0f; // Lower cap for more manageable gameplay
-                    }
-                    
-                    // Speed increases with each hit, adjusted per difficulty level
-                    float speedIncreaseFactor;
-                    switch (currentDifficulty) {
-                        case EASY:
-                            speedIncreaseFactor = -1.02f; // Increased from -1.01f for better gameplay at 60 FPS
-                            break;
-                        case MEDIUM:
-                            speedIncreaseFactor = -1.04f; // Increased from -1.02f for better gameplay at 60 FPS
-                            break;
-                        case HARD:
-                            speedIncreaseFactor = -1.06f; // Increased from -1.03f for better gameplay at 60 FPS
-                            break;
-                        case IMPOSSIBLE:
-                            speedIncreaseFactor = -1.08f * ball.impossibleSpeedMultiplier; // Increased from -1.06f for better gameplay at 60 FPS
-                            break;
-                        default:
-                            speedIncreaseFactor = -1.05f; // Increased from -1.03f for better gameplay at 60 FPS
-                    }                    ball.speedX *= speedIncreaseFactor;                    
-                    
-                    // Change Y speed based on where the ball hits the paddle                    
-                    float hitPosition = (ball.y - (playerPaddle.y + playerPaddle.height / 2)) / (playerPaddle.height / 2);
-                    ball.speedY = ball.speedY * 0.7f + hitPosition * 10; // Reduced for less aggressive angle changes
-                    
-                    if (paddleHit.frameCount > 0) PlaySound(paddleHit);                }                
-                
-                // Ball collision with computer paddle                
-                if (ball.x + ball.radius >= computerPaddle.x &&
-                    ball.y >= computerPaddle.y && ball.y <= computerPaddle.y + computerPaddle.height &&
-                    ball.speedX > 0) {
-                    
-                    // Track consecutive hits for IMPOSSIBLE difficulty
-                    ball.hitCounter++;
-                    
-                    // Update speed multiplier in IMPOSSIBLE mode
-                    if (currentDifficulty == IMPOSSIBLE && ball.hitCounter > 3) {
-                        ball.impossibleSpeedMultiplier += 0.05f; // Reduced from 0.08f for more gradual increase
-                        if (ball.impossibleSpeedMultiplier > 2.0f) ball.impossibleSpeedMultiplier = 2.0f; // Lower cap for more manageable gameplay
-                    }
-                    
-                    // Speed increases with each hit, adjusted per difficulty level
-                    float speedIncreaseFactor;
-                    switch (currentDifficulty) {
-                        case EASY:
-                            speedIncreaseFactor = -1.02f; // Increased from -1.01f for better gameplay at 60 FPS
-                            break;
-                        case MEDIUM:
-                            speedIncreaseFactor = -1.04f; // Increased from -1.02f for better gameplay at 60 FPS
-                            break;
-                        case HARD:
-                            speedIncreaseFactor = -1.06f; // Increased from -1.03f for better gameplay at 60 FPS
-                            break;
-                        case IMPOSSIBLE:
-                            speedIncreaseFactor = -1.08f * ball.impossibleSpeedMultiplier; // Increased from -1.06f for better gameplay at 60 FPS
-                            break;
-                        default:
-                            speedIncreaseFactor = -1.05f; // Increased from -1.03f for better gameplay at 60 FPS
-                    }                    ball.speedX *= speedIncreaseFactor;                    
-                    
-                    // Change Y speed based on where the ball hits the paddle                    
-                    float hitPosition = (ball.y - (computerPaddle.y + computerPaddle.height / 2)) / (computerPaddle.height / 2);
-                    ball.speedY = ball.speedY * 0.7f + hitPosition * 10; // Reduced for less aggressive angle changes
-                    
-                    if (paddleHit.frameCount > 0) PlaySound(paddleHit);
-                }                      // Score points when ball passes paddles (using court boundaries)
-                if (ball.x - ball.radius < COURT_X) {                        // Computer scores
-                    computerScore++;
-                    screenShake = 8.0f; // Trigger screen shake
-                    ResetBall(1); // Serve to player
-                    
-                    if (score.frameCount > 0) PlaySound(score);
-                    
-                    // Check for game over
-                    if (computerScore >= 10) {
-                        currentState = GAME_OVER;
-                    }
-                }
-                  if (ball.x + ball.radius > COURT_X + COURT_WIDTH) {                        // Player scores
-                    playerScore++;
-                    screenShake = 8.0f; // Trigger screen shake
-                    ResetBall(-1); // Serve to computer
-                    
-                    if (score.frameCount > 0) PlaySound(score);
-                    
-                    // Check for game over
-                    if (playerScore >= 10) {
-                        currentState = GAME_OVER;
-                    }
-                }                // Cap ball speed - different caps for different difficulty levels
-                float MAX_SPEED;
-                switch (currentDifficulty) {                        case EASY:
-                        MAX_SPEED = 18.0f;  // Reduced for more controllable gameplay
-                        break;                        case MEDIUM:
-                        MAX_SPEED = 24.0f;  // Reduced for more controllable gameplay
-                        break;                        case HARD:
-                        MAX_SPEED = 32.0f;  // Reduced for more controllable gameplay
-                        break;                        case IMPOSSIBLE:
-                        MAX_SPEED = 45.0f;  // Reduced but still very challenging
-                        break;
-                    default:
-                        MAX_SPEED = 22.0f;  // Reduced for more controllable gameplay
-                }
-                
-                if (ball.speedX > MAX_SPEED) ball.speedX = MAX_SPEED;
-                if (ball.speedX < -MAX_SPEED) ball.speedX = -MAX_SPEED;
-                if (ball.speedY > MAX_SPEED) ball.speedY = MAX_SPEED;
-                if (ball.speedY < -MAX_SPEED) ball.speedY = -MAX_SPEED;
+
+            // Advance the simulation in fixed steps, keeping the leftover time for interpolation
+            tickAccumulator += frameTime;
+            while (tickAccumulator >= SIM_DT && currentState == GAMEPLAY) {
+                UpdateGameplayTick(input);
+                tickAccumulator -= SIM_DT;
             }
             break;
-        }        case PAUSED: {
+        }
+                case PAUSED: {
             // Define button rectangles
             Rectangle resumeButton = { SCREEN_WIDTH/2 - 170, 410, 340, 65 };
             Rectangle menuButton = { SCREEN_WIDTH/2 - 170, 495, 340, 65 };
@@ -595,10 +1430,11 @@ void UpdateDrawFrame(void)
             break;
         }
         case GAME_OVER: {
+            // Keep answering the peer until we leave, it may still need our last inputs to confirm the result
+            if (netplayActive) PollNetplay(&netplay, &sim, GetTime());
             if (IsKeyPressed(KEY_R)) {
                 currentState = GAMEPLAY;
-                ResetBall(0);
-                playerScore = 0; computerScore = 0;
+                StartMatch(sim.difficulty);
             }
             else if (IsKeyPressed(KEY_SPACE)) {
                 currentState = DIFFICULTY_SELECT;
@@ -606,43 +1442,89 @@ void UpdateDrawFrame(void)
             break;
         }
     }
+    if (inputProfiled) EndProfileZone();
+
+    // Leaving the match or its game over screen ends the online session
+    if (netplayActive && currentState != GAMEPLAY && currentState != GAME_OVER) StopNetplay();
+    if (threadedSim) UpdateThreadedSim();
+
+    // A match left for the menus ends without a winner
+    if (telemetryMatchOpen && (currentState == MAIN_MENU || currentState == DIFFICULTY_SELECT || currentState == READY_TO_START)) {
+        EndMatchTelemetry(true);
+    }
+
+    // Start this frame's sounds in one go, gameplay only queued them
+    UpdateGameAudio();
     
+    // Outside of gameplay no ticks run, so rendering snaps to the current state
+    if (currentState != GAMEPLAY) SnapInterpolation();
+
+    // Interpolate between the last two ticks for smooth motion at any refresh rate
+    float tickAlpha = tickAccumulator / SIM_DT;
+    Vector2 ballPosition = {
+        prevBallPosition.x + (sim.ball.x - prevBallPosition.x) * tickAlpha,
+        prevBallPosition.y + (sim.ball.y - prevBallPosition.y) * tickAlpha
+    };
+    float playerPaddleY = prevPlayerPaddleY + (sim.playerPaddle.y - prevPlayerPaddleY) * tickAlpha;
+    float computerPaddleY = prevComputerPaddleY + (sim.computerPaddle.y - prevComputerPaddleY) * tickAlpha;
+    if (lowLatency && currentState == GAMEPLAY && !replayActive && !netplayActive) {
+        playerPaddleY = LeadPaddleY(sim.playerPaddle, frameInput, tickAlpha);
+    }
+
+    // Sample the trail only while the ball is in play, a new match or replay starts it over
+    if (currentState == GAMEPLAY) {
+        ballTrail[trailIndex] = ballPosition;
+        trailIndex = (trailIndex + 1) % trailLength;
+        if (trailCount < trailLength) trailCount++;
+    } else if (currentState != PAUSED) {
+        trailCount = 0;
+    }
+
     // Animation for background stars
+    bool starsProfiled = BeginProfileZone(PROFILE_STARFIELD);
     for (int i = 0; i < numStars; i++) {
-        stars[i].x -= 0.5f;
+        stars[i].x -= 30.0f * frameTime;
         if (stars[i].x < 0) {
             stars[i].x = SCREEN_WIDTH;
-            stars[i].y = GetRandomValue(0, SCREEN_HEIGHT);
+            stars[i].y = RngRange(&fxRng, 0, SCREEN_HEIGHT);
         }
     }
+    if (starsProfiled) EndProfileZone();
+
+    // Impact particles freeze with the game while paused
+    if (currentState == GAMEPLAY) {
+        ProfileScope profile(PROFILE_PARTICLES);
+        UpdateParticles(frameTime);
+    }
     
     //----------------------------------------------------------------------------------
     // Draw
     //----------------------------------------------------------------------------------
-    BeginDrawing();
+    UpdateRenderScale(frameTime, frameWorkTime);
+    ResizeSceneTarget();
+    camera.zoom = renderScale;
+    camera.offset = postShaderLoaded ? (Vector2){ 0, 0 } : (Vector2){ shakeOffset.x * renderScale, shakeOffset.y * renderScale };
+
+    BeginTextureMode(sceneTarget);
         ClearBackground(BLACK);
     BeginMode2D(camera);
         
         // Draw starfield background
-        for (int i = 0; i < numStars; i++) {
-            DrawCircle(stars[i].x, stars[i].y, 1.5f, GRAY);
-        }
-        // Draw court border
-        DrawRectangleLinesEx((Rectangle){COURT_X, COURT_Y, COURT_WIDTH, COURT_HEIGHT}, 2, DARKGRAY);
-        
-        // Draw center line (within court boundaries)
-        float centerX = COURT_X + COURT_WIDTH / 2;
-        for (int i = COURT_Y + 10; i < COURT_Y + COURT_HEIGHT - 10; i += 30) {
-            DrawRectangle(centerX - 2, i, 4, 15, DARKGRAY);
-        }
+        bool backgroundProfiled = BeginProfileZone(PROFILE_DRAW_BACKGROUND);
+        DrawStarfield(false);
+
+        // Draw court border and center line, render textures are stored upside down
+        DrawTextureRec(courtTexture.texture, (Rectangle){ 0, 0, (float)courtTexture.texture.width, (float)-courtTexture.texture.height }, (Vector2){ 0, 0 }, WHITE);
+        if (backgroundProfiled) EndProfileZone();
         
+        static const ProfileZone stateDrawZones[] = {
+            PROFILE_DRAW_MENU, PROFILE_DRAW_DIFFICULTY, PROFILE_DRAW_READY,
+            PROFILE_DRAW_GAMEPLAY, PROFILE_DRAW_GAMEPLAY, PROFILE_DRAW_GAME_OVER
+        };
+        bool drawProfiled = BeginProfileZone(stateDrawZones[currentState]);
         switch (currentState) {            case MAIN_MENU: {
                 // Background effect: animated stars with color variations
-                for (int i = 0; i < numStars; i++) {
-                    float starSize = (i % 4 == 0) ? 3.0f : ((i % 3 == 0) ? 2.0f : 1.2f);
-                    Color starColor = (i % 5 == 0) ? YELLOW : ((i % 7 == 0) ? SKYBLUE : WHITE);
-                    DrawCircle(stars[i].x, stars[i].y, starSize, ColorAlpha(starColor, 0.7f + 0.3f * sinf(GetTime() * 2 + i)));
-                }
+                DrawStarfield(true);
                 
                 // Semi-transparent overlay gradient for better readability
                 DrawRectangleGradientV(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 
@@ -652,18 +1534,18 @@ void UpdateDrawFrame(void)
                 const char* title = "PING PONG";
                 int titleSize = 105;
                 float bounceHeight = 5.0f * sinf(GetTime() * 3.0f); // Subtle bounce effect
-                int titleWidth = MeasureText(title, titleSize);
+                int titleWidth = MeasureTextCached(title, titleSize);
                 
                 // Draw colorful title with glowing effect and shadow
-                DrawText(title, SCREEN_WIDTH/2 - titleWidth/2 - 3, 120 + 3, titleSize, BLACK); // Shadow
+                DrawTextCached(title, SCREEN_WIDTH/2 - titleWidth/2 - 3, 120 + 3, titleSize, BLACK); // Shadow
                 
                 // Main title with glow effect
                 Color titleColor = ColorFromHSV(fmodf(GetTime() * 20, 360.0f), 0.7f, 1.0f); // Slow color cycle
-                DrawText(title, SCREEN_WIDTH/2 - titleWidth/2, 120 + bounceHeight, titleSize, titleColor);
+                DrawTextCached(title, SCREEN_WIDTH/2 - titleWidth/2, 120 + bounceHeight, titleSize, titleColor);
                 
                 // Subtitle with glow effect
-                DrawText("ARCADE EDITION", 
-                    SCREEN_WIDTH/2 - MeasureText("ARCADE EDITION", 32)/2, 
+                DrawTextCached("ARCADE EDITION", 
+                    SCREEN_WIDTH/2 - MeasureTextCached("ARCADE EDITION", 32)/2, 
                     230, 
                     32, ORANGE);
                 
@@ -674,8 +1556,8 @@ void UpdateDrawFrame(void)
                     3.0f, WHITE);
                 
                 // Name label with better styling
-                DrawText("ENTER YOUR NAME:", 
-                    SCREEN_WIDTH/2 - MeasureText("ENTER YOUR NAME:", 24)/2, 
+                DrawTextCached("ENTER YOUR NAME:", 
+                    SCREEN_WIDTH/2 - MeasureTextCached("ENTER YOUR NAME:", 24)/2, 
                     290, 
                     24, WHITE);
                 
@@ -686,7 +1568,7 @@ void UpdateDrawFrame(void)
                 DrawRectangleLines(nameBox.x, nameBox.y, nameBox.width, nameBox.height, WHITE);
                 
                 // Player name with better readability
-                DrawText(playerName, 
+                DrawTextCached(playerName, 
                     nameBox.x + 20, 
                     nameBox.y + nameBox.height/2 - 15, 
                     40, WHITE);
@@ -694,7 +1576,7 @@ void UpdateDrawFrame(void)
                 // Animated text cursor
                 if ((int)(GetTime() * 2) % 2 == 0) {
                     DrawRectangle(
-                        nameBox.x + 20 + MeasureText(playerName, 40), 
+                        nameBox.x + 20 + MeasureTextCached(playerName, 40), 
                         nameBox.y + 15, 
                         3, 30, 
                         ColorFromHSV(fmodf(GetTime() * 50, 360.0f), 0.8f, 1.0f));
@@ -733,16 +1615,16 @@ void UpdateDrawFrame(void)
                 float textScale = playPressed ? 0.95f : (playHover ? 1.05f : 1.0f);
                 int fontSize = 40 * textScale;
                 
-                DrawText("PLAY", 
-                    playButton.x + playButton.width/2 - MeasureText("PLAY", fontSize)/2, 
+                DrawTextCached("PLAY", 
+                    playButton.x + playButton.width/2 - MeasureTextCached("PLAY", fontSize)/2, 
                     playButton.y + playButton.height/2 - fontSize/2, 
                     fontSize, textColor);
                 
                 // Better keyboard hint with pulse effect
                 if (playEnabled) {
                     float alpha = 0.5f + 0.5f * sinf(GetTime() * 4);
-                    DrawText("Press ENTER to start", 
-                        SCREEN_WIDTH/2 - MeasureText("Press ENTER to start", 22)/2, 
+                    DrawTextCached("Press ENTER to start", 
+                        SCREEN_WIDTH/2 - MeasureTextCached("Press ENTER to start", 22)/2, 
                         500, 
                         22, ColorAlpha(WHITE, alpha));
                 }
@@ -750,11 +1632,7 @@ void UpdateDrawFrame(void)
             break;
               case DIFFICULTY_SELECT: {
                 // Background effect: animated stars with color variations
-                for (int i = 0; i < numStars; i++) {
-                    float starSize = (i % 4 == 0) ? 3.0f : ((i % 3 == 0) ? 2.0f : 1.2f);
-                    Color starColor = (i % 5 == 0) ? YELLOW : ((i % 7 == 0) ? SKYBLUE : WHITE);
-                    DrawCircle(stars[i].x, stars[i].y, starSize, ColorAlpha(starColor, 0.7f + 0.3f * sinf(GetTime() * 2 + i)));
-                }
+                DrawStarfield(true);
                 
                 // Semi-transparent overlay gradient for better readability
                 DrawRectangleGradientV(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 
@@ -764,14 +1642,14 @@ void UpdateDrawFrame(void)
                 const char* title = "SELECT DIFFICULTY";
                 int titleSize = 65;
                 float bounceHeight = 3.0f * sinf(GetTime() * 2.5f); // Subtle bounce effect
-                int titleWidth = MeasureText(title, titleSize);
+                int titleWidth = MeasureTextCached(title, titleSize);
                 
                 // Draw shadow for depth
-                DrawText(title, SCREEN_WIDTH/2 - titleWidth/2 - 3, 90 + 3, titleSize, BLACK);
+                DrawTextCached(title, SCREEN_WIDTH/2 - titleWidth/2 - 3, 90 + 3, titleSize, BLACK);
                 
                 // Main title with color animation
                 Color titleColor = ColorFromHSV(fmodf(GetTime() * 20, 360.0f), 0.7f, 1.0f); // Slow color cycle
-                DrawText(title, SCREEN_WIDTH/2 - titleWidth/2, 90 + bounceHeight, titleSize, titleColor);
+                DrawTextCached(title, SCREEN_WIDTH/2 - titleWidth/2, 90 + bounceHeight, titleSize, titleColor);
 
                 // Dynamic underline
                 DrawLineEx(
@@ -804,12 +1682,12 @@ void UpdateDrawFrame(void)
                     DrawRectangleGradientH(easyButton.x + 2, easyButton.y + 2, easyButton.width - 4, easyButton.height - 4, 
                                         DARKGREEN, GREEN);
                     DrawRectangleLines(easyButton.x + 2, easyButton.y + 2, easyButton.width - 4, easyButton.height - 4, WHITE);
-                    DrawText("1 - EASY", easyButton.x + 22, easyButton.y + easyButton.height/2 - 13, 36, WHITE);
+                    DrawTextCached("1 - EASY", easyButton.x + 22, easyButton.y + easyButton.height/2 - 13, 36, WHITE);
                 } else {
                     DrawRectangleGradientH(easyButton.x, easyButton.y, easyButton.width, easyButton.height, 
                                         easyHover ? LIME : GREEN, easyHover ? GREEN : DARKGREEN);
                     DrawRectangleLines(easyButton.x, easyButton.y, easyButton.width, easyButton.height, WHITE);
-                    DrawText("1 - EASY", easyButton.x + 20, easyButton.y + easyButton.height/2 - 15, 36, WHITE);
+                    DrawTextCached("1 - EASY", easyButton.x + 20, easyButton.y + easyButton.height/2 - 15, 36, WHITE);
                 }
                 DrawCircle(easyButton.x + 380, easyButton.y + easyButton.height/2, 5, 
                           ColorAlpha(WHITE, 0.5f + 0.5f * sinf(GetTime() * 3))); // Indicator light
@@ -819,12 +1697,12 @@ void UpdateDrawFrame(void)
                     DrawRectangleGradientH(mediumButton.x + 2, mediumButton.y + 2, mediumButton.width - 4, mediumButton.height - 4, 
                                         GOLD, ORANGE);
                     DrawRectangleLines(mediumButton.x + 2, mediumButton.y + 2, mediumButton.width - 4, mediumButton.height - 4, WHITE);
-                    DrawText("2 - MEDIUM", mediumButton.x + 22, mediumButton.y + mediumButton.height/2 - 13, 36, BLACK);
+                    DrawTextCached("2 - MEDIUM", mediumButton.x + 22, mediumButton.y + mediumButton.height/2 - 13, 36, BLACK);
                 } else {
                     DrawRectangleGradientH(mediumButton.x, mediumButton.y, mediumButton.width, mediumButton.height, 
                                         mediumHover ? GOLD : YELLOW, mediumHover ? ORANGE : GOLD);
                     DrawRectangleLines(mediumButton.x, mediumButton.y, mediumButton.width, mediumButton.height, WHITE);
-                    DrawText("2 - MEDIUM", mediumButton.x + 20, mediumButton.y + mediumButton.height/2 - 15, 36, BLACK);
+                    DrawTextCached("2 - MEDIUM", mediumButton.x + 20, mediumButton.y + mediumButton.height/2 - 15, 36, BLACK);
                 }
                 DrawCircle(mediumButton.x + 380, mediumButton.y + mediumButton.height/2, 5, 
                           ColorAlpha(WHITE, 0.5f + 0.5f * sinf(GetTime() * 3 + 1))); // Indicator light
@@ -834,13 +1712,13 @@ void UpdateDrawFrame(void)
                     DrawRectangleGradientH(hardButton.x + 2, hardButton.y + 2, hardButton.width - 4, hardButton.height - 4, 
                                         ORANGE, (Color){200, 80, 0, 255});
                     DrawRectangleLines(hardButton.x + 2, hardButton.y + 2, hardButton.width - 4, hardButton.height - 4, WHITE);
-                    DrawText("3 - HARD", hardButton.x + 22, hardButton.y + hardButton.height/2 - 13, 36, WHITE);
+                    DrawTextCached("3 - HARD", hardButton.x + 22, hardButton.y + hardButton.height/2 - 13, 36, WHITE);
                 } else {
                     DrawRectangleGradientH(hardButton.x, hardButton.y, hardButton.width, hardButton.height, 
                                         hardHover ? (Color){255, 180, 50, 255} : ORANGE, 
                                         hardHover ? RED : (Color){200, 80, 0, 255});
                     DrawRectangleLines(hardButton.x, hardButton.y, hardButton.width, hardButton.height, WHITE);
-                    DrawText("3 - HARD", hardButton.x + 20, hardButton.y + hardButton.height/2 - 15, 36, WHITE);
+                    DrawTextCached("3 - HARD", hardButton.x + 20, hardButton.y + hardButton.height/2 - 15, 36, WHITE);
                 }
                 DrawCircle(hardButton.x + 380, hardButton.y + hardButton.height/2, 5, 
                           ColorAlpha(WHITE, 0.5f + 0.5f * sinf(GetTime() * 3 + 2))); // Indicator light
@@ -853,26 +1731,26 @@ void UpdateDrawFrame(void)
                                         ColorAlpha(MAROON, warningPulse), 
                                         ColorAlpha((Color){100, 0, 0, 255}, warningPulse));
                     DrawRectangleLines(impossibleButton.x + 2, impossibleButton.y + 2, impossibleButton.width - 4, impossibleButton.height - 4, WHITE);
-                    DrawText("4 - IMPOSSIBLE", impossibleButton.x + 22, impossibleButton.y + impossibleButton.height/2 - 13, 36, WHITE);
+                    DrawTextCached("4 - IMPOSSIBLE", impossibleButton.x + 22, impossibleButton.y + impossibleButton.height/2 - 13, 36, WHITE);
                 } else {
                     DrawRectangleGradientH(impossibleButton.x, impossibleButton.y, impossibleButton.width, impossibleButton.height, 
                                         ColorAlpha(RED, warningPulse), 
                                         ColorAlpha(MAROON, warningPulse));
                     DrawRectangleLines(impossibleButton.x, impossibleButton.y, impossibleButton.width, impossibleButton.height, WHITE);
-                    DrawText("4 - IMPOSSIBLE", impossibleButton.x + 20, impossibleButton.y + impossibleButton.height/2 - 15, 36, WHITE);
+                    DrawTextCached("4 - IMPOSSIBLE", impossibleButton.x + 20, impossibleButton.y + impossibleButton.height/2 - 15, 36, WHITE);
                 }
                 DrawCircle(impossibleButton.x + 380, impossibleButton.y + impossibleButton.height/2, 5, 
                           ColorAlpha(WHITE, 0.5f + 0.5f * sinf(GetTime() * 10))); // Fast pulsing indicator
                   // Better navigation info with animated effects
                 float alpha1 = 0.7f + 0.3f * sinf(GetTime() * 3);
-                DrawText("PRESS NUMBER KEY OR CLICK TO SELECT DIFFICULTY", 
-                    SCREEN_WIDTH/2 - MeasureText("PRESS NUMBER KEY OR CLICK TO SELECT DIFFICULTY", 20)/2, 
+                DrawTextCached("PRESS NUMBER KEY OR CLICK TO SELECT DIFFICULTY", 
+                    SCREEN_WIDTH/2 - MeasureTextCached("PRESS NUMBER KEY OR CLICK TO SELECT DIFFICULTY", 20)/2, 
                     585, 
                     20, ColorAlpha(WHITE, alpha1));
                 
                 float alpha2 = 0.6f + 0.4f * sinf(GetTime() * 2);    
-                DrawText("PRESS BACKSPACE TO RETURN", 
-                    SCREEN_WIDTH/2 - MeasureText("PRESS BACKSPACE TO RETURN", 20)/2, 
+                DrawTextCached("PRESS BACKSPACE TO RETURN", 
+                    SCREEN_WIDTH/2 - MeasureTextCached("PRESS BACKSPACE TO RETURN", 20)/2, 
                     615, 
                     20, ColorAlpha(LIGHTGRAY, alpha2));
                     
@@ -887,78 +1765,100 @@ void UpdateDrawFrame(void)
                 
             case READY_TO_START: {
                 // Draw background and court as in gameplay
-                DrawRectangleRounded((Rectangle){playerPaddle.x, playerPaddle.y, playerPaddle.width, playerPaddle.height}, 0.8f, 10, playerPaddle.color);
-                DrawRectangleRounded((Rectangle){computerPaddle.x, computerPaddle.y, computerPaddle.width, computerPaddle.height}, 0.8f, 10, computerPaddle.color);
-                DrawCircleGradient(ball.x, ball.y, ball.radius+4, ColorAlpha(WHITE, 0.3f), ColorAlpha(WHITE, 0.0f));
-                DrawCircle(ball.x, ball.y, ball.radius, ball.color);
+                DrawLevel(fmaxf((float)sim.tick - 1.0f + tickAlpha, 0.0f));
+                DrawRectangleRounded((Rectangle){sim.playerPaddle.x, playerPaddleY, sim.playerPaddle.width, sim.playerPaddle.height}, 0.8f, 10, WHITE);
+                DrawRectangleRounded((Rectangle){sim.computerPaddle.x, computerPaddleY, sim.computerPaddle.width, sim.computerPaddle.height}, 0.8f, 10, RED);
+                DrawExtraBalls(tickAlpha);
+                DrawCircleGradient(ballPosition.x, ballPosition.y, sim.ball.radius+4, ColorAlpha(WHITE, 0.3f), ColorAlpha(WHITE, 0.0f));
+                DrawCircle(ballPosition.x, ballPosition.y, sim.ball.radius, WHITE);
                 // Draw Player Name and Score
-                DrawText(playerName, COURT_X + COURT_WIDTH/4 - MeasureText(playerName, 20)/2, COURT_Y + 5, 20, WHITE);
-                DrawText(TextFormat("%d", playerScore), COURT_X + COURT_WIDTH/4 - 15, COURT_Y + 30, 60, WHITE);
-                DrawText("COMPUTER", COURT_X + COURT_WIDTH*3/4 - MeasureText("COMPUTER", 20)/2, COURT_Y + 5, 20, RED);
-                DrawText(TextFormat("%d", computerScore), COURT_X + COURT_WIDTH*3/4 - 15, COURT_Y + 30, 60, RED);
+                const char *leftName = GetSideName(SIDE_PLAYER);
+                const char *rightName = GetSideName(SIDE_COMPUTER);
+                DrawTextCached(leftName, COURT_X + COURT_WIDTH/4 - MeasureTextCached(leftName, 20)/2, COURT_Y + 5, 20, WHITE);
+                DrawTextCached(TextFormat("%d", sim.playerScore), COURT_X + COURT_WIDTH/4 - 15, COURT_Y + 30, 60, WHITE);
+                DrawTextCached(rightName, COURT_X + COURT_WIDTH*3/4 - MeasureTextCached(rightName, 20)/2, COURT_Y + 5, 20, RED);
+                DrawTextCached(TextFormat("%d", sim.computerScore), COURT_X + COURT_WIDTH*3/4 - 15, COURT_Y + 30, 60, RED);
                 // Show difficulty
                 const char* difficultyText = "";
                 Color difficultyColor = WHITE;
-                switch(currentDifficulty) {
+                switch(sim.difficulty) {
                     case EASY: difficultyText = "EASY"; difficultyColor = GREEN; break;
                     case MEDIUM: difficultyText = "MEDIUM"; difficultyColor = YELLOW; break;
                     case HARD: difficultyText = "HARD"; difficultyColor = ORANGE; break;
                     case IMPOSSIBLE: difficultyText = "IMPOSSIBLE"; difficultyColor = RED; break;
                 }
-                DrawText(difficultyText, SCREEN_WIDTH / 2 - MeasureText(difficultyText, 30) / 2, 10, 30, difficultyColor);
+                DrawTextCached(difficultyText, SCREEN_WIDTH / 2 - MeasureTextCached(difficultyText, 30) / 2, 10, 30, difficultyColor);
                 // Show 'Press SPACE to start' message
                 float alpha = 0.6f + 0.4f * sinf(GetTime() * 3.0f);
-                DrawText("Press SPACE to start", SCREEN_WIDTH/2 - MeasureText("Press SPACE to start", 40)/2, SCREEN_HEIGHT/2 - 20, 40, ColorAlpha(WHITE, alpha));
+                DrawTextCached("Press SPACE to start", SCREEN_WIDTH/2 - MeasureTextCached("Press SPACE to start", 40)/2, SCREEN_HEIGHT/2 - 20, 40, ColorAlpha(WHITE, alpha));
+                const char *multiBallText = multiBall ? "B: MULTI-BALL ON" : "B: MULTI-BALL OFF";
+                DrawTextCached(multiBallText, SCREEN_WIDTH/2 - MeasureTextCached(multiBallText, 20)/2, SCREEN_HEIGHT/2 + 35, 20, multiBall ? GOLD : LIGHTGRAY);
+                const char *levelText = TextFormat("L: LEVEL %s", GetLevel(courtLevel)->name);
+                DrawTextCached(levelText, SCREEN_WIDTH/2 - MeasureTextCached(levelText, 20)/2, SCREEN_HEIGHT/2 + 60, 20, (courtLevel != LEVEL_CLASSIC) ? SKYBLUE : LIGHTGRAY);
             }
             break;
                 
             case GAMEPLAY:
             case PAUSED: {
                 // Draw all common game elements
-                DrawRectangleRounded((Rectangle){playerPaddle.x, playerPaddle.y, playerPaddle.width, playerPaddle.height}, 0.8f, 10, playerPaddle.color);
-                DrawRectangleRounded((Rectangle){computerPaddle.x, computerPaddle.y, computerPaddle.width, computerPaddle.height}, 0.8f, 10, computerPaddle.color);
+                DrawLevel(fmaxf((float)sim.tick - 1.0f + tickAlpha, 0.0f));
+                DrawRectangleRounded((Rectangle){sim.playerPaddle.x, playerPaddleY, sim.playerPaddle.width, sim.playerPaddle.height}, 0.8f, 10, WHITE);
+                DrawRectangleRounded((Rectangle){sim.computerPaddle.x, computerPaddleY, sim.computerPaddle.width, sim.computerPaddle.height}, 0.8f, 10, RED);
                 
                 // Only show trail after enough hits
-                if (ball.hitCounter >= GetTrailThreshold()) {
-                    for (int i = 0; i < TRAIL_LENGTH; i++) {
-                        int current = (trailIndex - 1 - i + TRAIL_LENGTH) % TRAIL_LENGTH;
-                        float alpha = 1.0f - ((float)i / TRAIL_LENGTH);
-                        DrawCircle(ballTrail[current].x, ballTrail[current].y, ball.radius, ColorAlpha(ball.color, alpha * 0.3f));
-                    }
-                }
+                if (sim.ball.hitCounter >= GetTrailThreshold()) DrawBallTrail(sim.ball.radius);
                 
-                DrawCircleGradient(ball.x, ball.y, ball.radius+4, ColorAlpha(WHITE, 0.3f), ColorAlpha(WHITE, 0.0f));
-                DrawCircle(ball.x, ball.y, ball.radius, ball.color);
+                DrawExtraBalls(tickAlpha);
+                DrawCircleGradient(ballPosition.x, ballPosition.y, sim.ball.radius+4, ColorAlpha(WHITE, 0.3f), ColorAlpha(WHITE, 0.0f));
+                DrawCircle(ballPosition.x, ballPosition.y, sim.ball.radius, WHITE);
+                DrawParticleLayer();
                 
                 // Draw Player Name and Score
-                DrawText(playerName, COURT_X + COURT_WIDTH/4 - MeasureText(playerName, 20)/2, COURT_Y + 5, 20, WHITE);
-                DrawText(TextFormat("%d", playerScore), COURT_X + COURT_WIDTH/4 - 15, COURT_Y + 30, 60, WHITE);
+                const char *leftName = GetSideName(SIDE_PLAYER);
+                const char *rightName = GetSideName(SIDE_COMPUTER);
+                DrawTextCached(leftName, COURT_X + COURT_WIDTH/4 - MeasureTextCached(leftName, 20)/2, COURT_Y + 5, 20, WHITE);
+                DrawTextCached(TextFormat("%d", sim.playerScore), COURT_X + COURT_WIDTH/4 - 15, COURT_Y + 30, 60, WHITE);
 
                 // Draw Computer Score
-                DrawText("COMPUTER", COURT_X + COURT_WIDTH*3/4 - MeasureText("COMPUTER", 20)/2, COURT_Y + 5, 20, RED);
-                DrawText(TextFormat("%d", computerScore), COURT_X + COURT_WIDTH*3/4 - 15, COURT_Y + 30, 60, RED);
+                DrawTextCached(rightName, COURT_X + COURT_WIDTH*3/4 - MeasureTextCached(rightName, 20)/2, COURT_Y + 5, 20, RED);
+                DrawTextCached(TextFormat("%d", sim.computerScore), COURT_X + COURT_WIDTH*3/4 - 15, COURT_Y + 30, 60, RED);
                 
                 const char* difficultyText = "";
                 Color difficultyColor = WHITE;
                 
-                switch(currentDifficulty) {
+                switch(sim.difficulty) {
                     case EASY: difficultyText = "EASY"; difficultyColor = GREEN; break;
                     case MEDIUM: difficultyText = "MEDIUM"; difficultyColor = YELLOW; break;
                     case HARD: difficultyText = "HARD"; difficultyColor = ORANGE; break;
                     case IMPOSSIBLE: difficultyText = "IMPOSSIBLE"; difficultyColor = RED; break;
                 }
-                DrawText(difficultyText, SCREEN_WIDTH / 2 - MeasureText(difficultyText, 30) / 2, 10, 30, difficultyColor);
+                DrawTextCached(difficultyText, SCREEN_WIDTH / 2 - MeasureTextCached(difficultyText, 30) / 2, 10, 30, difficultyColor);
                 
-                if (currentDifficulty == IMPOSSIBLE && ball.hitCounter > 3) {
+                if (sim.difficulty == IMPOSSIBLE && sim.ball.hitCounter > 3) {
                     char speedText[50];
-                    sprintf(speedText, "SPEED: %.1fX", ball.impossibleSpeedMultiplier);
-                    DrawText(speedText, SCREEN_WIDTH / 2 - MeasureText(speedText, 20) / 2, COURT_Y + COURT_HEIGHT - 25, 20, RED);
+                    sprintf(speedText, "SPEED: %.1fX", sim.ball.impossibleSpeedMultiplier);
+                    DrawTextCached(speedText, SCREEN_WIDTH / 2 - MeasureTextCached(speedText, 20) / 2, COURT_Y + COURT_HEIGHT - 25, 20, RED);
                 }
                 
                 // State-specific drawing
-                if (currentState == GAMEPLAY) {
-                    DrawText("SPACE for Pause", SCREEN_WIDTH - MeasureText("SPACE for Pause", 20) - 20, 10, 20, LIGHTGRAY);
-                    DrawText("M for Main Menu", SCREEN_WIDTH - MeasureText("M for Main Menu", 20) - 20, 35, 20, LIGHTGRAY);                } else if (currentState == PAUSED) {
+                if (currentState == GAMEPLAY && replayActive) {
+                    const char *replayText = TextFormat("REPLAY %s  %d:%02d / %d:%02d", replayFast ? "FAST" : "1X",
+                        playback.tick / SIM_TICK_RATE / 60, playback.tick / SIM_TICK_RATE % 60,
+                        loadedReplay.tickCount / SIM_TICK_RATE / 60, loadedReplay.tickCount / SIM_TICK_RATE % 60);
+                    DrawTextCached(replayText, SCREEN_WIDTH - MeasureTextCached(replayText, 20) - 20, 10, 20, SKYBLUE);
+                    DrawTextCached("TAB Fast  LEFT/RIGHT Seek", SCREEN_WIDTH - MeasureTextCached("TAB Fast  LEFT/RIGHT Seek", 20) - 20, 35, 20, LIGHTGRAY);
+                } else if (currentState == GAMEPLAY && netplayActive) {
+                    const char *netText = (netplay.state == NETPLAY_RUNNING) ?
+                        TextFormat("ONLINE  %d ms", (int)netplay.stats.rttMs) : "ONLINE";
+                    DrawTextCached(netText, SCREEN_WIDTH - MeasureTextCached(netText, 20) - 20, 10, 20, SKYBLUE);
+                    DrawTextCached("M for Main Menu", SCREEN_WIDTH - MeasureTextCached("M for Main Menu", 20) - 20, 35, 20, LIGHTGRAY);
+                    if (netplay.state == NETPLAY_CONNECTING) {
+                        const char *waitText = netplay.host ? "WAITING FOR OPPONENT..." : "CONNECTING...";
+                        DrawTextCached(waitText, SCREEN_WIDTH/2 - MeasureTextCached(waitText, 40)/2, SCREEN_HEIGHT/2 - 100, 40, SKYBLUE);
+                    }
+                } else if (currentState == GAMEPLAY) {
+                    DrawTextCached("SPACE for Pause", SCREEN_WIDTH - MeasureTextCached("SPACE for Pause", 20) - 20, 10, 20, LIGHTGRAY);
+                    DrawTextCached("M for Main Menu", SCREEN_WIDTH - MeasureTextCached("M for Main Menu", 20) - 20, 35, 20, LIGHTGRAY);                } else if (currentState == PAUSED) {
                     // Semi-transparent overlay with radial gradient for dramatic pause effect
                     DrawRectangleGradientV(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 
                                          ColorAlpha(BLACK, 0.85f), ColorAlpha(DARKBLUE, 0.7f));
@@ -977,7 +1877,7 @@ void UpdateDrawFrame(void)
                     
                     // Draw animated "PAUSED" text
                     Color pauseTextColor = ColorFromHSV(fmodf(GetTime() * 15, 360.0f), 0.7f, 1.0f);
-                    DrawText("PAUSED", SCREEN_WIDTH/2 - MeasureText("PAUSED", 80)/2, 300, 80, pauseTextColor);
+                    DrawTextCached("PAUSED", SCREEN_WIDTH/2 - MeasureTextCached("PAUSED", 80)/2, 300, 80, pauseTextColor);
                     
                     // Define button rectangles with better design
                     Rectangle resumeButton = { SCREEN_WIDTH/2 - 170, 410, 340, 65 };
@@ -1022,7 +1922,7 @@ void UpdateDrawFrame(void)
                         WHITE);
                     
                     // Draw button text with better style
-                    DrawText("RESUME GAME", 
+                    DrawTextCached("RESUME GAME", 
                         resumeButton.x + 75, 
                         resumeButton.y + resumeButton.height/2 - 15, 
                         30, WHITE);
@@ -1053,33 +1953,31 @@ void UpdateDrawFrame(void)
                         WHITE);
                     
                     // Draw button text with better style
-                    DrawText("MAIN MENU", 
+                    DrawTextCached("MAIN MENU", 
                         menuButton.x + 75, 
                         menuButton.y + menuButton.height/2 - 15, 
                         30, WHITE);
                     
                     // Animated keyboard controls reminder
                     float alpha = 0.6f + 0.4f * sinf(GetTime() * 4.0f);
-                    DrawText("Press SPACE to resume", 
-                        SCREEN_WIDTH/2 - MeasureText("Press SPACE to resume", 22)/2, 
+                    DrawTextCached("Press SPACE to resume", 
+                        SCREEN_WIDTH/2 - MeasureTextCached("Press SPACE to resume", 22)/2, 
                         590, 
                         22, ColorAlpha(WHITE, alpha));}
             }
             break;            case GAME_OVER: {
                 // Background effect: animated stars with color variations
-                for (int i = 0; i < numStars; i++) {
-                    float starSize = (i % 4 == 0) ? 3.0f : ((i % 3 == 0) ? 2.0f : 1.2f);
-                    Color starColor = (i % 5 == 0) ? YELLOW : ((i % 7 == 0) ? SKYBLUE : WHITE);
-                    DrawCircle(stars[i].x, stars[i].y, starSize, ColorAlpha(starColor, 0.7f + 0.3f * sinf(GetTime() * 2 + i)));
-                }
+                DrawStarfield(true);
                   
                 // Create a dynamic game over screen with gradient background
                 DrawRectangleGradientV(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 
                                     ColorAlpha(BLACK, 0.8f), ColorAlpha(DARKBLUE, 0.5f));
                   
-                // Animated scanlines effect for retro feel
-                for (int i = 0; i < SCREEN_HEIGHT; i += 4) {
-                    DrawRectangle(0, i, SCREEN_WIDTH, 1, ColorAlpha(BLACK, 0.15f));
+                // Animated scanlines effect for retro feel, done by the post-process pass when available
+                if (!postShaderLoaded) {
+                    for (int i = 0; i < SCREEN_HEIGHT; i += 4) {
+                        DrawRectangle(0, i, SCREEN_WIDTH, 1, ColorAlpha(BLACK, 0.15f));
+                    }
                 }
                 
                 // Game over title with pixel-like animated effects
@@ -1088,50 +1986,30 @@ void UpdateDrawFrame(void)
                 Color titleGlow = ColorFromHSV(fmodf(GetTime() * 30, 360.0f), 0.8f, 1.0f);
                 
                 // Draw shadow for depth
-                DrawText(gameOverText, 
-                    SCREEN_WIDTH/2 - MeasureText(gameOverText, 80)/2 + 3, 
+                DrawTextCached(gameOverText, 
+                    SCREEN_WIDTH/2 - MeasureTextCached(gameOverText, 80)/2 + 3, 
                     120 + 3, 
                     80, BLACK);
                 
                 // Main pulsing title
-                DrawText(gameOverText, 
-                    SCREEN_WIDTH/2 - MeasureText(gameOverText, 80)/2, 
+                DrawTextCached(gameOverText, 
+                    SCREEN_WIDTH/2 - MeasureTextCached(gameOverText, 80)/2, 
                     120 + bounceHeight, 
                     80, titleGlow);
                 
                 // Winner announcement with animated effects
-                if (playerScore > computerScore) {
+                if (sim.playerScore > sim.computerScore) {
                     // Player wins with celebration effects
-                    const char* winText = TextFormat("%s WINS!", playerName);
-                    
-                    // Victory glow effect
-                    float glowSize = 4.0f + 2.0f * sinf(GetTime() * 5.0f);
-                    for (float i = glowSize; i > 0; i -= 1.0f) {
-                        DrawText(winText, 
-                            SCREEN_WIDTH/2 - MeasureText(winText, 60)/2, 
-                            220, 
-                            60, ColorAlpha(GREEN, 0.1f * i));
-                    }
-                    
-                    DrawText(winText, 
-                        SCREEN_WIDTH/2 - MeasureText(winText, 60)/2, 
+                    const char* winText = TextFormat("%s WINS!", GetSideName(SIDE_PLAYER));
+                    DrawTextCached(winText, 
+                        SCREEN_WIDTH/2 - MeasureTextCached(winText, 60)/2, 
                         220, 
                         60, GREEN);
                 } else {
                     // Computer wins with intimidating effects
-                    const char* loseText = "COMPUTER WINS!";
-                    
-                    // Danger/defeat effect
-                    float glowSize = 3.0f + 2.0f * sinf(GetTime() * 8.0f);
-                    for (float i = glowSize; i > 0; i -= 1.0f) {
-                        DrawText(loseText, 
-                            SCREEN_WIDTH/2 - MeasureText(loseText, 60)/2, 
-                            220, 
-                            60, ColorAlpha(RED, 0.15f * i));
-                    }
-                    
-                    DrawText(loseText, 
-                        SCREEN_WIDTH/2 - MeasureText(loseText, 60)/2, 
+                    const char* loseText = TextFormat("%s WINS!", GetSideName(SIDE_COMPUTER));
+                    DrawTextCached(loseText, 
+                        SCREEN_WIDTH/2 - MeasureTextCached(loseText, 60)/2, 
                         220, 
                         60, RED);
                 }                // Retro-style arcade score display
@@ -1143,7 +2021,7 @@ void UpdateDrawFrame(void)
                 
                 // Animated border
                 float borderGlow = 0.7f + 0.3f * sinf(GetTime() * 3.0f);
-                Color borderColor = playerScore > computerScore ? 
+                Color borderColor = sim.playerScore > sim.computerScore ? 
                                   ColorAlpha(GREEN, borderGlow) : 
                                   ColorAlpha(RED, borderGlow);
                                   
@@ -1156,27 +2034,27 @@ void UpdateDrawFrame(void)
                     2, ColorAlpha(LIGHTGRAY, 0.8f));
                 
                 // Show player name and score with arcade style
-                DrawText(TextFormat("%s", playerName), 
+                DrawTextCached(GetSideName(SIDE_PLAYER), 
                     scoreBox.x + 30, 
                     scoreBox.y + 20, 
                     30, WHITE);
                 
                 // Create a digital score display effect
-                Color scoreColor = playerScore > computerScore ? GREEN : WHITE;
-                DrawText(TextFormat("%d", playerScore), 
+                Color scoreColor = sim.playerScore > sim.computerScore ? GREEN : WHITE;
+                DrawTextCached(TextFormat("%d", sim.playerScore), 
                     scoreBox.x + scoreBox.width - 90, 
                     scoreBox.y + 15, 
                     45, scoreColor);
                 
                 // Computer score display
-                DrawText("COMPUTER", 
+                DrawTextCached(GetSideName(SIDE_COMPUTER), 
                     scoreBox.x + 30, 
                     scoreBox.y + 75, 
                     30, RED);
                     
                 // Computer score with digital effect
-                Color compScoreColor = computerScore > playerScore ? RED : WHITE;
-                DrawText(TextFormat("%d", computerScore), 
+                Color compScoreColor = sim.computerScore > sim.playerScore ? RED : WHITE;
+                DrawTextCached(TextFormat("%d", sim.computerScore), 
                     scoreBox.x + scoreBox.width - 90, 
                     scoreBox.y + 75, 
                     45, compScoreColor);
@@ -1195,15 +2073,15 @@ void UpdateDrawFrame(void)
                 DrawRectangleLines(replayButton.x, replayButton.y, replayButton.width, replayButton.height, WHITE);
                 
                 float replayScale = replayHover ? 1.05f : 1.0f;
-                DrawText("PLAY AGAIN", 
-                    replayButton.x + replayButton.width/2 - MeasureText("PLAY AGAIN", 22 * replayScale)/2, 
+                DrawTextCached("PLAY AGAIN", 
+                    replayButton.x + replayButton.width/2 - MeasureTextCached("PLAY AGAIN", 22 * replayScale)/2, 
                     replayButton.y + replayButton.height/2 - 11 * replayScale, 
                     22 * replayScale, WHITE);
                 
                 // Draw key hint with animation
                 float hintAlpha = 0.6f + 0.4f * sinf(GetTime() * 3.0f);
-                DrawText("(R)", 
-                    replayButton.x + replayButton.width/2 - MeasureText("(R)", 16)/2,
+                DrawTextCached("(R)", 
+                    replayButton.x + replayButton.width/2 - MeasureTextCached("(R)", 16)/2,
                     replayButton.y + 38,
                     16, ColorAlpha(WHITE, hintAlpha));
                 
@@ -1213,21 +2091,21 @@ void UpdateDrawFrame(void)
                 DrawRectangleLines(diffButton.x, diffButton.y, diffButton.width, diffButton.height, WHITE);
                 
                 float diffScale = diffHover ? 1.05f : 1.0f;
-                DrawText("DIFFICULTY", 
-                    diffButton.x + diffButton.width/2 - MeasureText("DIFFICULTY", 22 * diffScale)/2, 
+                DrawTextCached("DIFFICULTY", 
+                    diffButton.x + diffButton.width/2 - MeasureTextCached("DIFFICULTY", 22 * diffScale)/2, 
                     diffButton.y + diffButton.height/2 - 11 * diffScale, 
                     22 * diffScale, BLACK);
                 
                 // Draw key hint with animation
-                DrawText("(SPACE)", 
-                    diffButton.x + diffButton.width/2 - MeasureText("(SPACE)", 16)/2,
+                DrawTextCached("(SPACE)", 
+                    diffButton.x + diffButton.width/2 - MeasureTextCached("(SPACE)", 16)/2,
                     diffButton.y + 38,
                     16, ColorAlpha(BLACK, hintAlpha));
                   // Difficulty info with arcade cabinet style
                 const char* gameOverDiffText = "";
                 Color gameOverDiffColor;
                 
-                switch(currentDifficulty) {
+                switch(sim.difficulty) {
                     case EASY:
                         gameOverDiffText = "EASY MODE";
                         gameOverDiffColor = GREEN;
@@ -1262,27 +2140,26 @@ void UpdateDrawFrame(void)
                 }
                 
                 // Draw difficulty text with shadow for depth
-                DrawText(gameOverDiffText,
-                    diffBox.x + diffBox.width/2 - MeasureText(gameOverDiffText, 28) / 2 + 2, 
+                DrawTextCached(gameOverDiffText,
+                    diffBox.x + diffBox.width/2 - MeasureTextCached(gameOverDiffText, 28) / 2 + 2, 
                     diffBox.y + 11 + 2, 
                     28, BLACK);
                     
-                DrawText(gameOverDiffText,
-                    diffBox.x + diffBox.width/2 - MeasureText(gameOverDiffText, 28) / 2, 
+                DrawTextCached(gameOverDiffText,
+                    diffBox.x + diffBox.width/2 - MeasureTextCached(gameOverDiffText, 28) / 2, 
                     diffBox.y + 11, 
                     28, gameOverDiffColor);
                   // Credits with classic arcade style
                 float creditsAlpha = 0.7f + 0.3f * sinf(GetTime() * 1.5f);
-                DrawText("THANKS FOR PLAYING!",
-                    SCREEN_WIDTH/2 - MeasureText("THANKS FOR PLAYING!", 24) / 2,
+                DrawTextCached("THANKS FOR PLAYING!",
+                    SCREEN_WIDTH/2 - MeasureTextCached("THANKS FOR PLAYING!", 24) / 2,
                     610, 
                     24, ColorAlpha(WHITE, creditsAlpha));
                   // Handle mouse clicks for buttons
                 if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
                     if (replayHover) {
                         currentState = GAMEPLAY;
-                        ResetBall(0);
-                        playerScore = 0; computerScore = 0;
+                        StartMatch(sim.difficulty);
                     } else if (diffHover) {
                         currentState = DIFFICULTY_SELECT;
                     }
@@ -1290,12 +2167,77 @@ void UpdateDrawFrame(void)
             }
             break;
         }
+        if (drawProfiled) EndProfileZone();
         
         EndMode2D();
+
+    bool postProfiled = BeginProfileZone(PROFILE_POSTFX);
+    CountBatchedDraws();
+    EndTextureMode();
+
+    // One full-screen pass: scanlines and bloom on the game over screen, shake whenever it's active
+    if (postShaderLoaded) {
+        float scanlines = (currentState == GAME_OVER) ? 0.15f : 0.0f;
+        float bloom = (currentState == GAME_OVER) ? 0.6f : 0.0f;
+        SetShaderValue(postShader, postShakeLoc, &shakeOffset, SHADER_UNIFORM_VEC2);
+        SetShaderValue(postShader, postScanlinesLoc, &scanlines, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(postShader, postBloomLoc, &bloom, SHADER_UNIFORM_FLOAT);
+    }
+
+    BeginDrawing();
+        ClearBackground(BLACK);     // The letterbox bars
+        if (postShaderLoaded) BeginShaderMode(postShader);
+            // Render textures are stored upside down
+            DrawTexturePro(sceneTarget.texture, (Rectangle){ 0, 0, (float)sceneTarget.texture.width, (float)-sceneTarget.texture.height },
+                           presentRect, (Vector2){ 0, 0 }, 0.0f, WHITE);
+            CountBatchedDraws();
+        if (postShaderLoaded) EndShaderMode();
+    if (postProfiled) EndProfileZone();
         
         // Draw FPS counter
         DrawFPS(10, 10);
+        if (lowLatency) DrawTextCached("LOW LATENCY", 10, 32, 20, LIME);
+        if (IsProfilerEnabled()) DrawProfilerOverlay();
+
+        // Drawn last, past the post-process pass, so the flash is the same on every screen
+        if (latencyFlash) DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), WHITE);
+        if (latencyTest) {
+            const char *latencyText = (latencySamples > 0) ?
+                TextFormat("LATENCY TEST  last %.1f ms  avg %.1f ms  (%d)", latencyLastMs, latencyAverageMs, latencySamples) :
+                "LATENCY TEST  press W/S or UP/DOWN";
+            DrawTextCached(latencyText, 10, GetScreenHeight() - 30, 20, latencyFlash ? BLACK : LIME);
+        }
         
+    CountBatchedDraws();
+    SetProfileDrawStats(frameDrawCalls, frameVertices);
+    if (!benchMode) UpdatePresentRate();
+    // A latency sample ends when the swap returns, with vsync when the flip happened and without it
+    // at once. EndDrawing() sleeps for the frame limiter after the swap, so the flash frame turns the
+    // limiter off and both modes are timed at the same point, with nothing but the input poll after it
+    bool sampleLatency = latencyFlash;
+#if !defined(PLATFORM_WEB)
+    if (sampleLatency) SetTargetFPS(0);
+#endif
+    frameWorkTime = (float)(GetTime() - frameStartTime);
+    bool presentProfiled = BeginProfileZone(PROFILE_PRESENT);
     EndDrawing();
+    if (presentProfiled) EndProfileZone();
+    if (sampleLatency) {
+        RecordLatencySample(GetTime());
+#if !defined(PLATFORM_WEB)
+        SetTargetFPS(pacedFps);     // The test holds the present rate at full, see UpdatePresentRate()
+#endif
+    }
+
+    // Time to first frame, tracked across builds to catch startup regressions
+    static bool firstFrameLogged = false;
+    if (!firstFrameLogged) {
+        firstFrameLogged = true;
+#if defined(PLATFORM_WEB)
+        TraceLog(LOG_INFO, "STARTUP: First frame %.0f ms after page load", emscripten_get_now());
+#else
+        TraceLog(LOG_INFO, "STARTUP: First frame %.0f ms after window creation", GetTime() * 1000.0);
+#endif
+    }
 }
     
\ No newline at end of file
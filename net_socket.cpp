@@ -0,0 +1,141 @@
+#include "net_socket.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// No raylib in this file, so the platform headers don't clash with its names
+#if defined(__EMSCRIPTEN__)
+    #define NET_UNAVAILABLE
+#elif defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    typedef int socklen_t;
+#else
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+#if !defined(NET_UNAVAILABLE)
+
+static bool InitSockets(void)
+{
+#if defined(_WIN32)
+    static bool started = false;
+    if (!started) {
+        WSADATA data;
+        started = (WSAStartup(MAKEWORD(2, 2), &data) == 0);
+    }
+    return started;
+#else
+    return true;
+#endif
+}
+
+static sockaddr_in ToSockaddr(const NetAddress *address)
+{
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(address->host);
+    addr.sin_port = htons(address->port);
+    return addr;
+}
+
+//----------------------------------------------------------------------------------
+// Module functions
+//----------------------------------------------------------------------------------
+NetSocket OpenUdpSocket(int port)
+{
+    if (!InitSockets()) return NET_INVALID_SOCKET;
+
+#if defined(_WIN32)
+    SOCKET handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == INVALID_SOCKET) return NET_INVALID_SOCKET;
+    u_long nonBlocking = 1;
+    bool ok = (ioctlsocket(handle, FIONBIO, &nonBlocking) == 0);
+#else
+    int handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle < 0) return NET_INVALID_SOCKET;
+    bool ok = (fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) == 0);
+#endif
+
+    NetAddress any = { INADDR_ANY, (uint16_t)port };
+    sockaddr_in addr = ToSockaddr(&any);
+    ok = ok && (bind(handle, (const sockaddr *)&addr, sizeof(addr)) == 0);
+    if (!ok) {
+        CloseUdpSocket((NetSocket)handle);
+        return NET_INVALID_SOCKET;
+    }
+    return (NetSocket)handle;
+}
+
+void CloseUdpSocket(NetSocket socket)
+{
+    if (socket == NET_INVALID_SOCKET) return;
+#if defined(_WIN32)
+    closesocket((SOCKET)socket);
+#else
+    close((int)socket);
+#endif
+}
+
+bool ResolveNetAddress(const char *text, NetAddress *address)
+{
+    if (!InitSockets()) return false;
+    const char *colon = strrchr(text, ':');
+    if (colon == NULL || colon == text) return false;
+    int port = atoi(colon + 1);
+    if (port <= 0 || port > 65535) return false;
+
+    std::string host(text, colon - text);
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *result = NULL;
+    if (getaddrinfo(host.c_str(), NULL, &hints, &result) != 0 || result == NULL) return false;
+
+    address->host = ntohl(((const sockaddr_in *)result->ai_addr)->sin_addr.s_addr);
+    address->port = (uint16_t)port;
+    freeaddrinfo(result);
+    return true;
+}
+
+bool SendUdp(NetSocket socket, const NetAddress *to, const void *data, int size)
+{
+    sockaddr_in addr = ToSockaddr(to);
+    return sendto(socket, (const char *)data, size, 0, (const sockaddr *)&addr, sizeof(addr)) == size;
+}
+
+int ReceiveUdp(NetSocket socket, void *buffer, int capacity, NetAddress *from)
+{
+    sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+    int size = (int)recvfrom(socket, (char *)buffer, capacity, 0, (sockaddr *)&addr, &length);
+    if (size <= 0) return 0;    // Would block, or an ICMP error from a peer that went away
+
+    from->host = ntohl(addr.sin_addr.s_addr);
+    from->port = ntohs(addr.sin_port);
+    return size;
+}
+
+#else
+
+NetSocket OpenUdpSocket(int port) { (void)port; return NET_INVALID_SOCKET; }
+void CloseUdpSocket(NetSocket socket) { (void)socket; }
+bool ResolveNetAddress(const char *text, NetAddress *address) { (void)text; (void)address; return false; }
+bool SendUdp(NetSocket socket, const NetAddress *to, const void *data, int size) { (void)socket; (void)to; (void)data; (void)size; return false; }
+int ReceiveUdp(NetSocket socket, void *buffer, int capacity, NetAddress *from) { (void)socket; (void)buffer; (void)capacity; (void)from; return 0; }
+
+#endif
+
+bool SameNetAddress(const NetAddress *a, const NetAddress *b)
+{
+    return (a->host == b->host) && (a->port == b->port);
+}
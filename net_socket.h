@@ -0,0 +1,26 @@
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+//----------------------------------------------------------------------------------
+// Minimal non-blocking UDP sockets over BSD sockets or Winsock
+// Browsers have no UDP, on the web build every call fails and online play is unavailable
+//----------------------------------------------------------------------------------
+#include <cstdint>
+
+struct NetAddress {
+    uint32_t host;              // IPv4, host byte order
+    uint16_t port;
+};
+
+typedef intptr_t NetSocket;
+static const NetSocket NET_INVALID_SOCKET = -1;
+
+NetSocket OpenUdpSocket(int port);              // Bound to every interface, 0 picks a free port
+void CloseUdpSocket(NetSocket socket);
+bool ResolveNetAddress(const char *text, NetAddress *address);   // "host:port", IPv4 or a host name
+
+bool SendUdp(NetSocket socket, const NetAddress *to, const void *data, int size);
+int ReceiveUdp(NetSocket socket, void *buffer, int capacity, NetAddress *from);     // Bytes read, 0 when nothing is waiting
+bool SameNetAddress(const NetAddress *a, const NetAddress *b);
+
+#endif // NET_SOCKET_H
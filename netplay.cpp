@@ -0,0 +1,404 @@
+#include "netplay.h"
+
+#include <cmath>
+#include <cstring>
+
+static const unsigned char NETPLAY_VERSION = 2;
+static const double NETPLAY_HELLO_INTERVAL = 0.1;       // Seconds between join attempts
+static const double NETPLAY_RESEND_INTERVAL = 0.02;     // Inputs go out at least this often, even while stalled
+static const double NETPLAY_TIMEOUT = 5.0;              // Silence before the peer counts as gone
+static const int NETPLAY_SYNC_INTERVAL = 10;            // Ticks between time-sync stalls
+static const int NETPLAY_PACKET_INPUTS = 96;            // Most inputs in one INPUT packet
+static const int INPUT_HEADER_SIZE = 26;
+
+enum NetplayPacketType {
+    PACKET_HELLO = 1,
+    PACKET_WELCOME,
+    PACKET_INPUT,
+    PACKET_QUIT
+};
+
+//----------------------------------------------------------------------------------
+// Module Internal Functions
+//----------------------------------------------------------------------------------
+static void PutU16(unsigned char *p, uint16_t v) { p[0] = v & 0xFF; p[1] = v >> 8; }
+static void PutU32(unsigned char *p, uint32_t v) { PutU16(p, v & 0xFFFF); PutU16(p + 2, v >> 16); }
+static uint16_t GetU16(const unsigned char *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t GetU32(const unsigned char *p) { return GetU16(p) | ((uint32_t)GetU16(p + 2) << 16); }
+
+static uint32_t Timestamp(double now)
+{
+    return (uint32_t)(now * 1000.0) + 1;    // Never 0, which means "nothing to echo yet"
+}
+
+static int WriteHeader(unsigned char *p, NetplayPacketType type)
+{
+    p[0] = 'P';
+    p[1] = 'N';
+    p[2] = (unsigned char)type;
+    p[3] = NETPLAY_VERSION;
+    return 4;
+}
+
+static void ResetSession(NetplaySession *session)
+{
+    memset(session, 0, sizeof(*session));
+    session->state = NETPLAY_IDLE;
+    session->socket = NET_INVALID_SOCKET;
+    session->firstMismatch = -1;
+    SeedRng(&session->conditionRng, 0x4E455450504F4E47ULL);
+}
+
+// Every packet goes through the latency and loss injector, delays of zero send straight away
+static void SendPacket(NetplaySession *session, const unsigned char *data, int size, double now)
+{
+    const NetConditions &conditions = session->conditions;
+    session->stats.packetsSent++;
+    session->lastSendTime = now;
+
+    if (conditions.lossPercent > 0 && RngRange(&session->conditionRng, 0, 9999) < (int)(conditions.lossPercent * 100)) {
+        session->stats.packetsDropped++;
+        return;
+    }
+
+    double delay = conditions.latencyMs;
+    if (conditions.jitterMs > 0) delay += conditions.jitterMs * RngRange(&session->conditionRng, 0, 1000) / 1000.0;
+    if (delay <= 0 || session->delayedCount == NETPLAY_DELAY_QUEUE) {
+        SendUdp(session->socket, &session->peer, data, size);
+        return;
+    }
+
+    DelayedPacket &packet = session->delayed[session->delayedCount++];
+    packet.sendTime = now + delay / 1000.0;
+    packet.size = size;
+    memcpy(packet.data, data, size);
+}
+
+static void FlushDelayedPackets(NetplaySession *session, double now)
+{
+    for (int i = 0; i < session->delayedCount;) {
+        DelayedPacket &packet = session->delayed[i];
+        if (packet.sendTime > now) {
+            i++;
+            continue;
+        }
+        SendUdp(session->socket, &session->peer, packet.data, packet.size);
+        packet = session->delayed[--session->delayedCount];     // Order doesn't matter, jitter reorders anyway
+    }
+}
+
+static void SendSimplePacket(NetplaySession *session, NetplayPacketType type, double now)
+{
+    unsigned char packet[4];
+    SendPacket(session, packet, WriteHeader(packet, type), now);
+}
+
+static void SendWelcome(NetplaySession *session, double now)
+{
+    unsigned char packet[16];
+    int size = WriteHeader(packet, PACKET_WELCOME);
+    packet[size++] = (unsigned char)session->difficulty;
+    PutU16(packet + size, (uint16_t)session->extraBalls); size += 2;
+    PutU32(packet + size, (uint32_t)session->seed); size += 4;
+    PutU32(packet + size, (uint32_t)(session->seed >> 32)); size += 4;
+    packet[size++] = (unsigned char)session->level;
+    SendPacket(session, packet, size, now);
+}
+
+// How many ticks ahead of the peer this side runs, from its last report and half the round trip
+static float LocalAdvantage(const NetplaySession *session)
+{
+    return session->tick - (session->peerTick + session->stats.rttMs * 0.5f * SIM_TICK_RATE / 1000.0f);
+}
+
+static void SendInputs(NetplaySession *session, double now)
+{
+    int first = session->ackTick;
+    int count = session->tick + NETPLAY_INPUT_DELAY - first;
+    if (count > NETPLAY_PACKET_INPUTS) count = NETPLAY_PACKET_INPUTS;
+
+    float advantage = LocalAdvantage(session);
+    if (advantage < -127) advantage = -127;
+    if (advantage > 127) advantage = 127;
+    uint32_t echo = 0;
+    if (session->peerTimestamp != 0) echo = session->peerTimestamp + (uint32_t)((now - session->peerTimestampTime) * 1000.0);
+
+    unsigned char packet[NETPLAY_MAX_PACKET];
+    unsigned char *p = packet + WriteHeader(packet, PACKET_INPUT);
+    PutU32(p, (uint32_t)session->tick); p += 4;
+    PutU32(p, (uint32_t)session->remoteTick); p += 4;
+    *p++ = (unsigned char)(signed char)lroundf(advantage);
+    PutU32(p, Timestamp(now)); p += 4;
+    PutU32(p, echo); p += 4;
+    PutU32(p, (uint32_t)first); p += 4;
+    *p++ = (unsigned char)count;
+    for (int i = 0; i < count; i++) *p++ = session->localInputs[(first + i) & (NETPLAY_INPUT_RING - 1)];
+
+    SendPacket(session, packet, (int)(p - packet), now);
+}
+
+static void StartNetplayMatch(NetplaySession *session, PongSim *sim, double now)
+{
+    InitPongSim(sim, session->difficulty, session->seed);
+    sim->controllers[SIDE_PLAYER] = CONTROLLER_HUMAN;
+    sim->controllers[SIDE_COMPUTER] = CONTROLLER_HUMAN;
+    SetPongSimLevel(sim, session->level);
+    SetPongSimExtraBalls(sim, session->extraBalls);
+
+    session->state = NETPLAY_RUNNING;
+    session->tick = 0;
+    session->remoteTick = 0;
+    session->ackTick = 0;
+    session->firstMismatch = -1;
+    session->eventTick = 0;
+    session->syncStallTick = -NETPLAY_SYNC_INTERVAL;
+    memset(session->localInputs, 0, sizeof(session->localInputs));     // The input delay's first ticks are idle
+    memset(session->remoteInputs, 0, sizeof(session->remoteInputs));
+    session->lastReceiveTime = now;
+}
+
+static unsigned int CombineInputs(const NetplaySession *session, int tick)
+{
+    unsigned int local = session->localInputs[tick & (NETPLAY_INPUT_RING - 1)];
+    unsigned int remote = session->remoteInputs[tick & (NETPLAY_INPUT_RING - 1)];
+    if (session->localSide == SIDE_PLAYER) return local | (remote << 2);
+    return remote | (local << 2);
+}
+
+// The remote input a tick is simulated with: confirmed if it arrived, otherwise the last confirmed one
+static void PredictRemoteInput(NetplaySession *session, int tick)
+{
+    if (tick < session->remoteTick) return;
+    unsigned char last = (session->remoteTick > 0) ? session->remoteInputs[(session->remoteTick - 1) & (NETPLAY_INPUT_RING - 1)] : 0;
+    session->remoteInputs[tick & (NETPLAY_INPUT_RING - 1)] = last;
+}
+
+static void SimulateTick(NetplaySession *session, PongSim *sim, int tick)
+{
+    SavePongSimSnapshot(sim, session->snapshots[tick % NETPLAY_SNAPSHOTS]);
+    PredictRemoteInput(session, tick);
+    StepPongSim(sim, CombineInputs(session, tick));
+
+    // This run's events replace an earlier run's, or those of the tick NETPLAY_SNAPSHOTS back
+    int slot = tick % NETPLAY_SNAPSHOTS;
+    if (tick - NETPLAY_SNAPSHOTS >= session->eventTick) session->eventTick = tick - NETPLAY_SNAPSHOTS + 1;
+    memcpy(session->tickEvents[slot], sim->events, sim->eventCount * sizeof(SimEvent));
+    session->tickEventCounts[slot] = sim->eventCount;
+}
+
+// Restore the state before the first mispredicted tick and simulate forward to the present
+static void Rollback(NetplaySession *session, PongSim *sim)
+{
+    int from = session->firstMismatch;
+    if (from < 0) return;
+    session->firstMismatch = -1;
+
+    LoadPongSimSnapshot(sim, session->snapshots[from % NETPLAY_SNAPSHOTS]);
+    for (int tick = from; tick < session->tick; tick++) SimulateTick(session, sim, tick);
+
+    int depth = session->tick - from;
+    session->stats.rollbacks++;
+    session->stats.resimulatedTicks += depth;
+    if (depth > session->stats.maxRollbackTicks) session->stats.maxRollbackTicks = depth;
+}
+
+static void ReceiveInputs(NetplaySession *session, const unsigned char *data, int size, double now)
+{
+    if (size < INPUT_HEADER_SIZE) return;
+    const unsigned char *p = data + 4;
+    int peerTick = (int)GetU32(p); p += 4;
+    int ackTick = (int)GetU32(p); p += 4;
+    float advantage = (float)(signed char)*p++;
+    uint32_t timestamp = GetU32(p); p += 4;
+    uint32_t echo = GetU32(p); p += 4;
+    int first = (int)GetU32(p); p += 4;
+    int count = *p++;
+    if (size < INPUT_HEADER_SIZE + count) return;
+
+    // Packets can arrive out of order, only newer news counts
+    if (peerTick >= session->peerTick) {
+        session->peerTick = peerTick;
+        session->peerAdvantage = advantage;
+        session->peerTimestamp = timestamp;
+        session->peerTimestampTime = now;
+    }
+    if (ackTick > session->ackTick && ackTick <= session->tick + NETPLAY_INPUT_DELAY) session->ackTick = ackTick;
+    if (echo != 0) {
+        float sample = (float)(Timestamp(now) - echo);
+        session->stats.rttMs = (session->stats.rttMs == 0) ? sample : session->stats.rttMs * 0.9f + sample * 0.1f;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int tick = first + i;
+        if (tick < session->remoteTick) continue;
+        if (tick > session->remoteTick || tick >= session->tick + NETPLAY_INPUT_RING / 2) break;
+
+        unsigned char &input = session->remoteInputs[tick & (NETPLAY_INPUT_RING - 1)];
+        unsigned char actual = p[i] & (INPUT_PLAYER_UP | INPUT_PLAYER_DOWN);
+        if (tick < session->tick && input != actual && session->firstMismatch < 0) session->firstMismatch = tick;
+        input = actual;
+        session->remoteTick++;
+    }
+}
+
+//----------------------------------------------------------------------------------
+// Module functions
+//----------------------------------------------------------------------------------
+bool HostNetplay(NetplaySession *session, int port, DifficultyLevel difficulty, uint64_t seed, int extraBalls, int level)
+{
+    ResetSession(session);
+    session->socket = OpenUdpSocket(port);
+    if (session->socket == NET_INVALID_SOCKET) return false;
+
+    session->state = NETPLAY_CONNECTING;
+    session->host = true;
+    session->localSide = SIDE_PLAYER;
+    session->difficulty = difficulty;
+    session->seed = seed;
+    session->extraBalls = extraBalls;
+    session->level = level;
+    return true;
+}
+
+bool JoinNetplay(NetplaySession *session, const char *address)
+{
+    ResetSession(session);
+    if (!ResolveNetAddress(address, &session->peer)) return false;
+    session->socket = OpenUdpSocket(0);
+    if (session->socket == NET_INVALID_SOCKET) return false;
+
+    session->state = NETPLAY_CONNECTING;
+    session->host = false;
+    session->localSide = SIDE_COMPUTER;
+    session->lastSendTime = -NETPLAY_HELLO_INTERVAL;
+    return true;
+}
+
+void SetNetplayConditions(NetplaySession *session, NetConditions conditions)
+{
+    session->conditions = conditions;
+}
+
+void CloseNetplay(NetplaySession *session)
+{
+    if (session->socket != NET_INVALID_SOCKET) {
+        if (session->state == NETPLAY_RUNNING) {
+            unsigned char packet[4];
+            SendUdp(session->socket, &session->peer, packet, WriteHeader(packet, PACKET_QUIT));
+        }
+        CloseUdpSocket(session->socket);
+    }
+    session->socket = NET_INVALID_SOCKET;
+    session->state = NETPLAY_IDLE;
+}
+
+NetplayState PollNetplay(NetplaySession *session, PongSim *sim, double now)
+{
+    if (session->state == NETPLAY_IDLE || session->state == NETPLAY_DISCONNECTED) return session->state;
+
+    FlushDelayedPackets(session, now);
+
+    unsigned char data[NETPLAY_MAX_PACKET];
+    NetAddress from;
+    int size;
+    while ((size = ReceiveUdp(session->socket, data, sizeof(data), &from)) > 0) {
+        if (size < 4 || data[0] != 'P' || data[1] != 'N' || data[3] != NETPLAY_VERSION) continue;
+
+        // The host takes the first peer that says hello, after that only packets from the peer count
+        bool fromPeer = SameNetAddress(&from, &session->peer);
+        if (session->host && session->state == NETPLAY_CONNECTING && data[2] == PACKET_HELLO) {
+            session->peer = from;
+            fromPeer = true;
+            StartNetplayMatch(session, sim, now);
+        }
+        if (!fromPeer) continue;
+        session->stats.packetsReceived++;
+        session->lastReceiveTime = now;
+
+        switch (data[2]) {
+            case PACKET_HELLO:
+                if (session->host) SendWelcome(session, now);
+                break;
+            case PACKET_WELCOME:
+                if (!session->host && session->state == NETPLAY_CONNECTING && size >= 16) {
+                    session->difficulty = (DifficultyLevel)data[4];
+                    session->extraBalls = GetU16(data + 5);
+                    session->seed = GetU32(data + 7) | ((uint64_t)GetU32(data + 11) << 32);
+                    session->level = data[15];
+                    StartNetplayMatch(session, sim, now);
+                }
+                break;
+            case PACKET_INPUT:
+                if (session->state == NETPLAY_RUNNING) ReceiveInputs(session, data, size, now);
+                break;
+            case PACKET_QUIT:
+                session->state = NETPLAY_DISCONNECTED;
+                break;
+            default:
+                break;
+        }
+        if (session->state == NETPLAY_DISCONNECTED) return session->state;
+    }
+
+    if (session->state == NETPLAY_CONNECTING) {
+        if (!session->host && now - session->lastSendTime >= NETPLAY_HELLO_INTERVAL) SendSimplePacket(session, PACKET_HELLO, now);
+        return session->state;
+    }
+
+    if (now - session->lastReceiveTime > NETPLAY_TIMEOUT) {
+        session->state = NETPLAY_DISCONNECTED;
+        return session->state;
+    }
+
+    Rollback(session, sim);
+
+    // Keeps inputs flowing while stalled, so a lost packet can't leave both sides waiting
+    if (now - session->lastSendTime >= NETPLAY_RESEND_INTERVAL) SendInputs(session, now);
+    return session->state;
+}
+
+bool AdvanceNetplay(NetplaySession *session, PongSim *sim, unsigned int localInput, double now)
+{
+    if (session->state != NETPLAY_RUNNING) return false;
+
+    // Out of snapshots to roll back to, or out of room for inputs the peer hasn't acknowledged
+    bool waiting = (session->tick - session->remoteTick >= NETPLAY_MAX_ROLLBACK) ||
+                   (session->tick + NETPLAY_INPUT_DELAY - session->ackTick >= NETPLAY_INPUT_RING - 1);
+
+    // Time sync: the side that runs ahead skips a tick now and then, so rollbacks stay shallow for both
+    if (!waiting && (LocalAdvantage(session) - session->peerAdvantage) / 2 >= 1.0f &&
+        session->tick - session->syncStallTick >= NETPLAY_SYNC_INTERVAL) {
+        session->syncStallTick = session->tick;
+        waiting = true;
+    }
+    if (waiting) {
+        session->stats.stalls++;
+        return false;
+    }
+
+    session->localInputs[(session->tick + NETPLAY_INPUT_DELAY) & (NETPLAY_INPUT_RING - 1)] =
+        (unsigned char)(localInput & (INPUT_PLAYER_UP | INPUT_PLAYER_DOWN));
+    SimulateTick(session, sim, session->tick);
+    session->tick++;
+
+    SendInputs(session, now);
+    FlushDelayedPackets(session, now);
+    return true;
+}
+
+bool IsNetplayConfirmed(const NetplaySession *session)
+{
+    return (session->state == NETPLAY_RUNNING) && (session->remoteTick >= session->tick) && (session->firstMismatch < 0);
+}
+
+bool TakeNetplayConfirmedEvents(NetplaySession *session, const SimEvent **events, int *eventCount)
+{
+    int tick = session->eventTick;
+    if (session->state != NETPLAY_RUNNING || tick >= session->remoteTick || tick >= session->tick) return false;
+    if (session->firstMismatch >= 0 && tick >= session->firstMismatch) return false;
+
+    session->eventTick++;
+    *events = session->tickEvents[tick % NETPLAY_SNAPSHOTS];
+    *eventCount = session->tickEventCounts[tick % NETPLAY_SNAPSHOTS];
+    return true;
+}
@@ -0,0 +1,126 @@
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+//----------------------------------------------------------------------------------
+// Two-player online play with rollback over UDP
+//
+// Both peers run the same deterministic PongSim. Each tick uses the local input at once
+// and a prediction of the remote one (its last known input). When real remote input
+// arrives and differs from what was predicted, the simulation is restored from the
+// snapshot taken before that tick and re-simulated up to the present, so a connection
+// of up to about 100 ms round trip plays like a local one
+//
+// The host is the left paddle and picks difficulty, seed, multi-ball and level; the peer that
+// joins plays the right paddle. Every input packet repeats all inputs the other side has
+// not acknowledged yet, so lost packets need no retransmission
+//
+// Packets, little-endian, all starting with char[2] "PN", uint8 type, uint8 version:
+//   HELLO    joiner asks to play
+//   WELCOME  uint8 difficulty, uint16 extra balls, uint64 seed, uint8 level
+//   INPUT    uint32 sender tick, uint32 ack tick, int8 advantage, uint32 timestamp ms,
+//            uint32 echoed timestamp ms, uint32 first tick, uint8 count, uint8[count] inputs
+//   QUIT     sender left
+//----------------------------------------------------------------------------------
+#include <cstdint>
+
+#include "net_socket.h"
+#include "pong_rng.h"
+#include "pong_sim.h"
+
+static const int NETPLAY_DEFAULT_PORT = 7777;
+static const int NETPLAY_INPUT_DELAY = 2;           // Ticks local input is held back, hides the shortest round trips entirely
+static const int NETPLAY_MAX_ROLLBACK = 30;         // Furthest the simulation runs ahead of confirmed remote input, 250 ms
+static const int NETPLAY_INPUT_RING = 128;          // Input history, power of two
+static const int NETPLAY_SNAPSHOTS = NETPLAY_MAX_ROLLBACK + 1;
+static const int NETPLAY_MAX_PACKET = 128;
+static const int NETPLAY_DELAY_QUEUE = 256;         // Packets held back by the latency injector
+
+enum NetplayState {
+    NETPLAY_IDLE,
+    NETPLAY_CONNECTING,
+    NETPLAY_RUNNING,
+    NETPLAY_DISCONNECTED
+};
+
+// Artificial network conditions applied to outgoing packets, for testing on one machine
+struct NetConditions {
+    float latencyMs;                // Added one-way delay
+    float jitterMs;                 // Extra random delay on top, up to this much, so packets also reorder
+    float lossPercent;              // Chance of dropping a packet
+};
+
+struct NetplayStats {
+    float rttMs;
+    int rollbacks;                  // Mispredictions corrected
+    int maxRollbackTicks;           // Deepest re-simulation
+    long long resimulatedTicks;
+    int stalls;                     // Ticks skipped waiting for the peer or to let it catch up
+    int packetsSent, packetsReceived, packetsDropped;
+};
+
+struct DelayedPacket {
+    double sendTime;
+    int size;
+    unsigned char data[NETPLAY_MAX_PACKET];
+};
+
+struct NetplaySession {
+    NetplayState state;
+    bool host;
+    CourtSide localSide;
+    NetSocket socket;
+    NetAddress peer;
+
+    DifficultyLevel difficulty;     // Match setup, chosen by the host and sent in WELCOME
+    uint64_t seed;
+    int extraBalls;
+    int level;
+
+    int tick;                       // Next tick to simulate
+    int remoteTick;                 // Remote input is confirmed for every tick before this one
+    int ackTick;                    // The peer holds our input for every tick before this one
+    int firstMismatch;              // Earliest tick simulated with a wrong prediction, -1 when none
+    int syncStallTick;              // Last tick held back for time sync
+    unsigned char localInputs[NETPLAY_INPUT_RING];      // Own paddle bits, INPUT_PLAYER_UP / INPUT_PLAYER_DOWN
+    unsigned char remoteInputs[NETPLAY_INPUT_RING];     // Confirmed input, or the prediction the tick was simulated with
+    unsigned char snapshots[NETPLAY_SNAPSHOTS][PONG_SIM_SNAPSHOT_MAX];   // State before each recent tick
+    SimEvent tickEvents[NETPLAY_SNAPSHOTS][SIM_MAX_EVENTS];             // Events from each recent tick's latest run
+    int tickEventCounts[NETPLAY_SNAPSHOTS];
+    int eventTick;                  // Next tick whose events TakeNetplayConfirmedEvents() hands out
+
+    int peerTick;                   // Latest tick the peer reported
+    float peerAdvantage;            // How far ahead the peer thinks it is, in ticks
+    uint32_t peerTimestamp;         // Latest peer clock seen, echoed back for round-trip time
+    double peerTimestampTime;
+    double lastReceiveTime;
+    double lastSendTime;
+
+    NetConditions conditions;
+    PongRng conditionRng;
+    DelayedPacket delayed[NETPLAY_DELAY_QUEUE];
+    int delayedCount;
+
+    NetplayStats stats;
+};
+
+bool HostNetplay(NetplaySession *session, int port, DifficultyLevel difficulty, uint64_t seed, int extraBalls, int level);  // Wait for a peer on port
+bool JoinNetplay(NetplaySession *session, const char *address);     // "host:port"
+void SetNetplayConditions(NetplaySession *session, NetConditions conditions);
+void CloseNetplay(NetplaySession *session);                         // Tells the peer, then closes the socket
+
+// Send and receive, call every frame. Initializes sim once the peers connect and rolls it
+// back and forward again whenever a prediction turns out wrong
+NetplayState PollNetplay(NetplaySession *session, PongSim *sim, double now);
+
+// Simulate one tick with this tick's local input, own paddle bits only. False when the tick
+// was held back waiting for the peer, sim.events are only fresh after a true return
+bool AdvanceNetplay(NetplaySession *session, PongSim *sim, unsigned int localInput, double now);
+
+bool IsNetplayConfirmed(const NetplaySession *session);             // Every simulated tick used real remote input
+
+// Events of the oldest tick not taken yet, once that tick used real remote input and no rollback
+// can change it. False when there is no such tick. Ticks left untaken for NETPLAY_SNAPSHOTS ticks
+// are dropped
+bool TakeNetplayConfirmedEvents(NetplaySession *session, const SimEvent **events, int *eventCount);
+
+#endif // NETPLAY_H
@@ -0,0 +1,169 @@
+#include "particles.h"
+#include "simd4.h"
+
+#include <cmath>
+
+//----------------------------------------------------------------------------------
+// Pool, structure-of-arrays so the update runs four particles per instruction
+//----------------------------------------------------------------------------------
+static const float PARTICLE_DRAG = 0.93f;           // Velocity kept per 60 Hz frame
+
+struct ParticlePool {
+    alignas(16) float x[MAX_PARTICLES];
+    alignas(16) float y[MAX_PARTICLES];
+    alignas(16) float speedX[MAX_PARTICLES];
+    alignas(16) float speedY[MAX_PARTICLES];
+    alignas(16) float life[MAX_PARTICLES];          // Seconds left
+    alignas(16) float invLifetime[MAX_PARTICLES];   // For the fade, 1 / starting life
+    float size[MAX_PARTICLES];                      // Sprite half-size at full life
+    Color color[MAX_PARTICLES];
+    int count;
+};
+
+static ParticlePool pool;
+static Texture2D particleTexture;
+static rlRenderBatch particleBatch;
+static bool particlesReady = false;
+
+// Spawn parameters per effect
+struct ParticleEffectParams {
+    int count;
+    float minSpeed, maxSpeed;   // Pixels per second
+    float spread;               // Half-angle of the spray in radians, PI for all around
+    float minLife, maxLife;
+    float minSize, maxSize;
+};
+
+static const ParticleEffectParams effectParams[3] = {
+    { 28, 240.0f, 720.0f, 0.9f, 0.25f, 0.55f, 2.0f, 4.0f },    // PARTICLE_SPARKS
+    { 14, 40.0f, 140.0f, 1.2f, 0.35f, 0.70f, 3.0f, 6.0f },     // PARTICLE_DUST
+    { 240, 120.0f, 900.0f, PI, 0.50f, 1.20f, 2.5f, 6.0f }      // PARTICLE_BURST
+};
+
+static float RandomBetween(PongRng *rng, float min, float max)
+{
+    return min + (max - min) * RngFloat(rng);
+}
+
+//----------------------------------------------------------------------------------
+// Module functions
+//----------------------------------------------------------------------------------
+void InitParticles(void)
+{
+    Image image = GenImageGradientRadial(16, 16, 0.2f, WHITE, BLANK);
+    particleTexture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    SetTextureFilter(particleTexture, TEXTURE_FILTER_BILINEAR);
+
+    particleBatch = rlLoadRenderBatch(1, PARTICLE_BATCH_QUADS);
+    particlesReady = (particleTexture.id > 0);
+    pool.count = 0;
+}
+
+void UnloadParticles(void)
+{
+    if (!particlesReady) return;
+    rlUnloadRenderBatch(particleBatch);
+    UnloadTexture(particleTexture);
+    particlesReady = false;
+}
+
+void ClearParticles(void)
+{
+    pool.count = 0;
+}
+
+void SpawnParticles(ParticleEffect effect, float x, float y, float directionX, Color color, PongRng *rng)
+{
+    const ParticleEffectParams &params = effectParams[effect];
+    float baseAngle = (directionX < 0) ? PI : 0.0f;
+    float spread = (directionX == 0) ? PI : params.spread;
+
+    for (int n = 0; n < params.count && pool.count < MAX_PARTICLES; n++) {
+        int i = pool.count++;
+        float angle = baseAngle + RandomBetween(rng, -spread, spread);
+        float speed = RandomBetween(rng, params.minSpeed, params.maxSpeed);
+        float life = RandomBetween(rng, params.minLife, params.maxLife);
+
+        pool.x[i] = x;
+        pool.y[i] = y;
+        pool.speedX[i] = cosf(angle) * speed;
+        pool.speedY[i] = sinf(angle) * speed;
+        pool.life[i] = life;
+        pool.invLifetime[i] = 1.0f / life;
+        pool.size[i] = RandomBetween(rng, params.minSize, params.maxSize);
+        pool.color[i] = color;
+    }
+}
+
+void UpdateParticles(float dt)
+{
+    if (pool.count == 0) return;
+
+    // Integrate everything, padding lanes past count are harmless garbage
+    const Float4 step = Splat4(dt);
+    const Float4 drag = Splat4(powf(PARTICLE_DRAG, dt * 60.0f));
+    for (int i = 0; i < pool.count; i += 4) {
+        Float4 speedX = Load4(pool.speedX + i), speedY = Load4(pool.speedY + i);
+        Store4(pool.x + i, Add4(Load4(pool.x + i), Mul4(speedX, step)));
+        Store4(pool.y + i, Add4(Load4(pool.y + i), Mul4(speedY, step)));
+        Store4(pool.speedX + i, Mul4(speedX, drag));
+        Store4(pool.speedY + i, Mul4(speedY, drag));
+        Store4(pool.life + i, Sub4(Load4(pool.life + i), step));
+    }
+
+    // Swap-remove the dead, the last live particle fills each hole
+    int i = 0;
+    while (i < pool.count) {
+        if (pool.life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+        int last = --pool.count;
+        pool.x[i] = pool.x[last];
+        pool.y[i] = pool.y[last];
+        pool.speedX[i] = pool.speedX[last];
+        pool.speedY[i] = pool.speedY[last];
+        pool.life[i] = pool.life[last];
+        pool.invLifetime[i] = pool.invLifetime[last];
+        pool.size[i] = pool.size[last];
+        pool.color[i] = pool.color[last];
+    }
+}
+
+int DrawParticles(rlRenderBatch *resumeBatch)
+{
+    if (!particlesReady || pool.count == 0) return 0;
+
+    // Switching batches flushes whatever the caller had queued, so particles land on top
+    rlSetRenderBatchActive(&particleBatch);
+    BeginBlendMode(BLEND_ADDITIVE);
+    rlSetTexture(particleTexture.id);
+
+    for (int start = 0; start < pool.count; start += PARTICLE_BATCH_QUADS) {
+        int end = (pool.count - start > PARTICLE_BATCH_QUADS) ? start + PARTICLE_BATCH_QUADS : pool.count;
+        rlCheckRenderBatchLimit(4 * (end - start));
+        rlBegin(RL_QUADS);
+        for (int i = start; i < end; i++) {
+            float fade = pool.life[i] * pool.invLifetime[i];
+            float half = pool.size[i] * (0.4f + 0.6f * fade);
+            Color color = pool.color[i];
+            rlColor4ub(color.r, color.g, color.b, (unsigned char)(color.a * fade));
+            rlTexCoord2f(0.0f, 0.0f); rlVertex2f(pool.x[i] - half, pool.y[i] - half);
+            rlTexCoord2f(0.0f, 1.0f); rlVertex2f(pool.x[i] - half, pool.y[i] + half);
+            rlTexCoord2f(1.0f, 1.0f); rlVertex2f(pool.x[i] + half, pool.y[i] + half);
+            rlTexCoord2f(1.0f, 0.0f); rlVertex2f(pool.x[i] + half, pool.y[i] - half);
+        }
+        rlEnd();
+    }
+
+    rlSetTexture(0);
+    EndBlendMode();
+    rlSetRenderBatchActive(resumeBatch);
+    return pool.count;
+}
+
+int GetParticleCount(void)
+{
+    return pool.count;
+}
@@ -0,0 +1,35 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+//----------------------------------------------------------------------------------
+// Particle pool for impact effects: sparks on paddle hits, dust on wall bounces
+// and bursts on goals. Fixed capacity, nothing is allocated after InitParticles(),
+// dead particles are swap-removed so the live ones stay packed at the front
+// All particles are drawn additively through one dedicated batch
+//----------------------------------------------------------------------------------
+#include <raylib.h>
+#include <rlgl.h>
+
+#include "pong_rng.h"
+
+static const int MAX_PARTICLES = 32768;
+static const int PARTICLE_BATCH_QUADS = 16384;     // 65536 vertices, the most 16-bit indices address on OpenGL ES 2.0
+
+enum ParticleEffect {
+    PARTICLE_SPARKS,            // Fast, short-lived, sprayed away from a paddle face
+    PARTICLE_DUST,              // Slow puff off a wall
+    PARTICLE_BURST              // Large ring for a goal
+};
+
+void InitParticles(void);       // Create the sprite and the batch, call after InitWindow()
+void UnloadParticles(void);
+void ClearParticles(void);
+
+// directionX biases the spray: 1 to the right, -1 to the left, 0 all around
+// Spawns fewer particles once the pool is full, never evicts live ones
+void SpawnParticles(ParticleEffect effect, float x, float y, float directionX, Color color, PongRng *rng);
+void UpdateParticles(float dt);
+int DrawParticles(rlRenderBatch *resumeBatch);     // Returns quads drawn, resumeBatch (NULL for rlgl's default) is made active again
+int GetParticleCount(void);
+
+#endif // PARTICLES_H
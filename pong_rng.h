@@ -0,0 +1,67 @@
+#ifndef PONG_RNG_H
+#define PONG_RNG_H
+
+//----------------------------------------------------------------------------------
+// Small seedable PRNG (xoshiro128**), one instance per stream
+// Gameplay and visual effects each own a stream, so cosmetic randomness never
+// shifts the simulation and a match replays bit-exactly from its seed
+//----------------------------------------------------------------------------------
+#include <cstdint>
+
+struct PongRng {
+    uint32_t state[4];
+};
+
+static inline uint32_t RotateLeft32(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+// Expand a 64-bit seed into the full state with splitmix64, so nearby seeds give unrelated streams
+static inline void SeedRng(PongRng *rng, uint64_t seed)
+{
+    for (int i = 0; i < 4; i += 2) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z = z ^ (z >> 31);
+        rng->state[i] = (uint32_t)z;
+        rng->state[i + 1] = (uint32_t)(z >> 32);
+    }
+}
+
+static inline uint32_t NextRng(PongRng *rng)
+{
+    uint32_t *s = rng->state;
+    uint32_t result = RotateLeft32(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RotateLeft32(s[3], 11);
+
+    return result;
+}
+
+// Random integer in [min, max], same contract as raylib's GetRandomValue()
+static inline int RngRange(PongRng *rng, int min, int max)
+{
+    if (min > max) {
+        int tmp = max;
+        max = min;
+        min = tmp;
+    }
+    uint64_t range = (uint64_t)((int64_t)max - min) + 1;
+    return min + (int)(((uint64_t)NextRng(rng) * range) >> 32);
+}
+
+// Random float in [0, 1)
+static inline float RngFloat(PongRng *rng)
+{
+    return (NextRng(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+#endif // PONG_RNG_H
@@ -0,0 +1,902 @@
+#include "pong_sim.h"
+#include "level.h"
+#include "simd4.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+//----------------------------------------------------------------------------------
+// Module Internal Functions
+//----------------------------------------------------------------------------------
+
+static SimEvent *PushEvent(PongSim *sim, SimEventType type, CourtSide side)
+{
+    if (sim->eventCount >= SIM_MAX_EVENTS) return NULL;
+    SimEvent &event = sim->events[sim->eventCount++];
+    event.type = type;
+    event.side = side;
+    event.x = sim->ball.x;
+    event.y = sim->ball.y;
+    event.speedX = sim->ball.speedX;
+    event.speedY = sim->ball.speedY;
+    event.hitPosition = 0.0f;
+    event.speedClamped = false;
+    event.obstacle = -1;
+    event.tick = sim->tick;
+    return &event;
+}
+
+// --- Perfect Arcade Feel Player Paddle Control ---
+static void UpdateHumanPaddle(Paddle *paddle, bool moveUp, bool moveDown)
+{
+    const float acceleration = 7.0f;  // Very high acceleration for instant response
+    const float friction = 0.5f;      // Lower friction for precise control and faster stops
+    const float maxVelocity = 22.0f;  // Higher max velocity for lightning-fast movement
+    const float directionChangeBoost = 1.5f; // Extra boost when changing directions
+    static const float tickFriction = powf(friction, TICK_SCALE); // Same decay per second at any tick rate
+
+    // Apply acceleration based on key press for extremely responsive control
+    if (moveUp) {
+        // Instant direction change with extra boost for arcade-perfect feel
+        if (paddle->velocityY > 0) {
+            paddle->velocityY = -acceleration * directionChangeBoost; // Boosted immediate direction change
+        } else {
+            paddle->velocityY -= acceleration * TICK_SCALE; // Direct acceleration for responsive control
+        }
+
+        // Immediate boost to high speed for arcade feel
+        if (fabsf(paddle->velocityY) < maxVelocity * 0.5f) {
+            paddle->velocityY = -maxVelocity * 0.7f; // Quick ramp-up to 70% of max speed
+        }
+    } else if (moveDown) {
+        // Instant direction change with extra boost for arcade-perfect feel
+        if (paddle->velocityY < 0) {
+            paddle->velocityY = acceleration * directionChangeBoost; // Boosted immediate direction change
+        } else {
+            paddle->velocityY += acceleration * TICK_SCALE; // Direct acceleration for responsive control
+        }
+
+        // Immediate boost to high speed for arcade feel
+        if (fabsf(paddle->velocityY) < maxVelocity * 0.5f) {
+            paddle->velocityY = maxVelocity * 0.7f; // Quick ramp-up to 70% of max speed
+        }
+    } else {
+        // Apply stronger friction for crisp stops - arcade machines stop quickly
+        if (fabsf(paddle->velocityY) > 0.5f) {
+            paddle->velocityY *= tickFriction;
+        } else {
+            paddle->velocityY = 0; // Complete stop when near zero for crisp feel
+        }
+    }
+
+    // Clamp velocity to max speed
+    if (paddle->velocityY > maxVelocity) paddle->velocityY = maxVelocity;
+    if (paddle->velocityY < -maxVelocity) paddle->velocityY = -maxVelocity;
+
+    // Apply an aggressive deadzone to prevent tiny drifting movements
+    if (fabsf(paddle->velocityY) < 0.3f) paddle->velocityY = 0;
+
+    // Update paddle position based on velocity
+    paddle->y += paddle->velocityY * TICK_SCALE;
+
+    // Keep paddle within court bounds and reset velocity on collision
+    if (paddle->y < COURT_Y) {
+        paddle->y = COURT_Y;
+        paddle->velocityY = 0;
+    }
+    if (paddle->y + paddle->height > COURT_Y + COURT_HEIGHT) {
+        paddle->y = COURT_Y + COURT_HEIGHT - paddle->height;
+        paddle->velocityY = 0;
+    }
+}
+
+// Paddle AI, tracks the ball while it is coming towards this side
+static void UpdateAIPaddle(PongSim *sim, CourtSide side)
+{
+    const AIParams &ai = sim->ai[side];
+    const Ball &ball = sim->ball;
+    Paddle *paddle = (side == SIDE_PLAYER) ? &sim->playerPaddle : &sim->computerPaddle;
+
+    float paddleCenter = paddle->y + paddle->height / 2;
+    float ballTrackPosition = ball.y;
+
+    // Add prediction based on difficulty
+    bool incoming = (side == SIDE_PLAYER) ? (ball.speedX < 0) : (ball.speedX > 0);
+    if (incoming) {
+        // The intercept only changes when the ball bounces or is served, so it's computed
+        // once per straight leg of the trajectory and reused every tick until then
+        if (!sim->predictionValid[side]) {
+            float faceX = (side == SIDE_PLAYER) ? paddle->x + paddle->width : paddle->x;
+            float predictedY = PredictBallY(&ball, faceX, false);
+
+            if (ai.advancedPrediction) {
+                // Add prediction error to make it more human
+                if (ai.predictionError > 0) {
+                    predictedY += RngRange(&sim->rng, -(int)ai.predictionError, (int)ai.predictionError);
+                }
+                predictedY = FoldCourtY(predictedY, ball.radius);
+            }
+
+            sim->predictedY[side] = predictedY;
+            sim->predictionValid[side] = true;
+        }
+        ballTrackPosition = sim->predictedY[side];
+    }
+
+    // Add difficulty-based movement
+    if (RngRange(&sim->rng, 0, 100) < ai.accuracy * 100) {  // Chance to react based on accuracy
+        if (paddleCenter < ballTrackPosition - ai.deadZone) {
+            paddle->y += ai.paddleSpeed * ai.reactionSpeed * TICK_SCALE;
+        } else if (paddleCenter > ballTrackPosition + ai.deadZone) {
+            paddle->y -= ai.paddleSpeed * ai.reactionSpeed * TICK_SCALE;
+        }
+    }
+
+    // Keep paddle within court bounds
+    if (paddle->y < COURT_Y) paddle->y = COURT_Y;
+    if (paddle->y + paddle->height > COURT_Y + COURT_HEIGHT) {
+        paddle->y = COURT_Y + COURT_HEIGHT - paddle->height;
+    }
+}
+
+// The ball's trajectory changed, cached AI intercepts no longer apply
+static void InvalidatePredictions(PongSim *sim)
+{
+    sim->predictionValid[SIDE_PLAYER] = false;
+    sim->predictionValid[SIDE_COMPUTER] = false;
+}
+
+// True when either axis had to be held to the difficulty's top speed
+static bool ClampBallSpeed(PongSim *sim)
+{
+    Ball &ball = sim->ball;
+    float maxSpeed = sim->params.maxSpeed;
+    bool clamped = fabsf(ball.speedX) > maxSpeed || fabsf(ball.speedY) > maxSpeed;
+
+    if (ball.speedX > maxSpeed) ball.speedX = maxSpeed;
+    if (ball.speedX < -maxSpeed) ball.speedX = -maxSpeed;
+    if (ball.speedY > maxSpeed) ball.speedY = maxSpeed;
+    if (ball.speedY < -maxSpeed) ball.speedY = -maxSpeed;
+    return clamped;
+}
+
+// Bounce the ball back off a paddle, speeding it up, angling it by hit position and holding it
+// to the top speed
+static void BounceOffPaddle(PongSim *sim, const Paddle &paddle, CourtSide side)
+{
+    Ball &ball = sim->ball;
+
+    // Track consecutive hits for IMPOSSIBLE difficulty
+    ball.hitCounter++;
+
+    // Update speed multiplier in IMPOSSIBLE mode
+    if (sim->params.speedRamp && ball.hitCounter > 3) {
+        ball.impossibleSpeedMultiplier += 0.05f; // Reduced from 0.08f for more gradual increase
+        if (ball.impossibleSpeedMultiplier > 2.0f) ball.impossibleSpeedMultiplier = 2.0f; // Lower cap for more manageable gameplay
+    }
+
+    // Speed increases with each hit, adjusted per difficulty level
+    float speedIncreaseFactor = sim->params.speedIncreaseFactor;
+    if (sim->params.speedRamp) speedIncreaseFactor *= ball.impossibleSpeedMultiplier;
+    ball.speedX *= speedIncreaseFactor;
+
+    // Change Y speed based on where the ball hits the paddle
+    float hitPosition = (ball.y - (paddle.y + paddle.height / 2)) / (paddle.height / 2);
+    ball.speedY = ball.speedY * 0.7f + hitPosition * 10; // Reduced for less aggressive angle changes
+
+    InvalidatePredictions(sim);
+    bool clamped = ClampBallSpeed(sim);
+    SimEvent *event = PushEvent(sim, SIM_EVENT_PADDLE_HIT, side);
+    if (event != NULL) {
+        event->hitPosition = hitPosition;
+        event->speedClamped = clamped;
+    }
+}
+
+// Earliest time in [0, *t) at which a circle moving by (dx, dy) touches the rectangle.
+// Sweeps the circle center against the rectangle grown by the radius: four flat sides plus
+// four rounded corners. Only surfaces the circle is moving into are reported.
+static bool SweepCircleRect(float x, float y, float dx, float dy, float radius,
+                            float rectX, float rectY, float rectWidth, float rectHeight,
+                            float *t, float *normalX, float *normalY)
+{
+    bool hit = false;
+    float left = rectX, right = rectX + rectWidth;
+    float top = rectY, bottom = rectY + rectHeight;
+
+    // Early out when the bounds of the whole move don't reach the rectangle
+    float minX = fminf(x, x + dx) - radius, maxX = fmaxf(x, x + dx) + radius;
+    float minY = fminf(y, y + dy) - radius, maxY = fmaxf(y, y + dy) + radius;
+    if (maxX < left || minX > right || maxY < top || minY > bottom) return false;
+
+    // Flat sides: plane crossing, then check the contact lies along the side
+    if (dx > 0) {
+        float tx = (left - radius - x) / dx;
+        float hy = y + dy * tx;
+        if (tx >= 0 && tx < *t && hy >= top && hy <= bottom) { *t = tx; *normalX = -1; *normalY = 0; hit = true; }
+    } else if (dx < 0) {
+        float tx = (right + radius - x) / dx;
+        float hy = y + dy * tx;
+        if (tx >= 0 && tx < *t && hy >= top && hy <= bottom) { *t = tx; *normalX = 1; *normalY = 0; hit = true; }
+    }
+    if (dy > 0) {
+        float ty = (top - radius - y) / dy;
+        float hx = x + dx * ty;
+        if (ty >= 0 && ty < *t && hx >= left && hx <= right) { *t = ty; *normalX = 0; *normalY = -1; hit = true; }
+    } else if (dy < 0) {
+        float ty = (bottom + radius - y) / dy;
+        float hx = x + dx * ty;
+        if (ty >= 0 && ty < *t && hx >= left && hx <= right) { *t = ty; *normalX = 0; *normalY = 1; hit = true; }
+    }
+
+    // Rounded corners: ray against a circle of the ball's radius around each corner
+    const float cornersX[4] = { left, right, left, right };
+    const float cornersY[4] = { top, top, bottom, bottom };
+    float a = dx * dx + dy * dy;
+    if (a <= 0) return hit;
+
+    for (int i = 0; i < 4; i++) {
+        float ox = x - cornersX[i];
+        float oy = y - cornersY[i];
+        float b = ox * dx + oy * dy;
+        float c = ox * ox + oy * oy - radius * radius;
+        if (b >= 0 || c < 0) continue;     // Moving away, or already overlapping
+
+        float discriminant = b * b - a * c;
+        if (discriminant < 0) continue;
+
+        float tc = (-b - sqrtf(discriminant)) / a;
+        if (tc >= 0 && tc < *t) {
+            float hx = ox + dx * tc, hy = oy + dy * tc;
+            // Only count corner contacts outside the flat sides' ranges
+            bool outsideX = (hx + cornersX[i] < left) || (hx + cornersX[i] > right);
+            bool outsideY = (hy + cornersY[i] < top) || (hy + cornersY[i] > bottom);
+            if (!outsideX || !outsideY) continue;
+
+            *t = tc;
+            *normalX = hx / radius;
+            *normalY = hy / radius;
+            hit = true;
+        }
+    }
+
+    return hit;
+}
+
+static bool IsBrickBroken(const PongSim *sim, int obstacle)
+{
+    return (sim->brokenBricks[obstacle >> 5] & (1u << (obstacle & 31))) != 0;
+}
+
+// Earliest obstacle contact in [0, *t) for a move of the scoring ball, -1 when there is none.
+// Only the obstacles filed in the grid cells the whole move touches are swept; one filed in
+// several of those cells is swept more than once, which can't change the earliest hit
+static int SweepObstacles(const PongSim *sim, const Level *level, float dx, float dy,
+                          float *t, float *normalX, float *normalY)
+{
+    const Ball &ball = sim->ball;
+    LevelCellRange cells = GetLevelCells(fminf(ball.x, ball.x + dx) - ball.radius, fminf(ball.y, ball.y + dy) - ball.radius,
+                                         fmaxf(ball.x, ball.x + dx) + ball.radius, fmaxf(ball.y, ball.y + dy) + ball.radius);
+    int hit = -1;
+    for (int row = cells.row0; row <= cells.row1; row++) {
+        for (int column = cells.column0; column <= cells.column1; column++) {
+            int c = row * LEVEL_GRID_COLUMNS + column;
+            for (int k = level->cellStart[c]; k < level->cellStart[c + 1]; k++) {
+                int index = level->cellItems[k];
+                const Obstacle &obstacle = level->obstacles[index];
+                if (obstacle.type == OBSTACLE_BRICK && IsBrickBroken(sim, index)) continue;
+                if (SweepCircleRect(ball.x, ball.y, dx, dy, ball.radius, obstacle.x, GetObstacleY(&obstacle, (float)sim->tick),
+                                    obstacle.width, obstacle.height, t, normalX, normalY)) {
+                    hit = index;
+                }
+            }
+        }
+    }
+    return hit;
+}
+
+// Reflect the scoring ball off an obstacle surface. Bumpers kick it back faster, bricks break
+static void BounceOffObstacle(PongSim *sim, const Level *level, int index, float normalX, float normalY)
+{
+    Ball &ball = sim->ball;
+    const Obstacle &obstacle = level->obstacles[index];
+
+    float dot = ball.speedX * normalX + ball.speedY * normalY;
+    ball.speedX -= 2 * dot * normalX;
+    ball.speedY -= 2 * dot * normalY;
+    if (fabsf(ball.speedX) < OBSTACLE_MIN_SPEED_X) ball.speedX = copysignf(OBSTACLE_MIN_SPEED_X, ball.speedX);
+    if (obstacle.type == OBSTACLE_BUMPER) {
+        ball.speedX *= BUMPER_KICK;
+        ball.speedY *= BUMPER_KICK;
+        ClampBallSpeed(sim);
+    } else if (obstacle.type == OBSTACLE_BRICK) {
+        sim->brokenBricks[index >> 5] |= 1u << (index & 31);
+    }
+
+    InvalidatePredictions(sim);
+    CourtSide side = (ball.x < COURT_X + COURT_WIDTH / 2) ? SIDE_PLAYER : SIDE_COMPUTER;
+    SimEvent *event = PushEvent(sim, SIM_EVENT_OBSTACLE_HIT, side);
+    if (event != NULL) event->obstacle = index;
+}
+
+// A paddle that moved onto the ball still returns it, as long as the ball hasn't gone behind it
+static void ResolvePaddleOverlap(PongSim *sim, const Paddle &paddle, CourtSide side)
+{
+    Ball &ball = sim->ball;
+    if (ball.y < paddle.y || ball.y > paddle.y + paddle.height) return;
+
+    if (side == SIDE_PLAYER) {
+        float face = paddle.x + paddle.width;
+        if (ball.speedX < 0 && ball.x >= paddle.x && ball.x - ball.radius < face) {
+            ball.x = face + ball.radius;
+            BounceOffPaddle(sim, paddle, side);
+        }
+    } else {
+        float face = paddle.x;
+        if (ball.speedX > 0 && ball.x <= paddle.x + paddle.width && ball.x + ball.radius > face) {
+            ball.x = face - ball.radius;
+            BounceOffPaddle(sim, paddle, side);
+        }
+    }
+}
+
+// Continuous collision for one tick of ball motion.
+// Finds the earliest contact (wall, paddle or obstacle), moves the ball there, responds, and
+// continues with the remaining motion, so fast balls can't skip past a paddle and
+// hits use the ball position at the moment of impact.
+static void MoveBall(PongSim *sim)
+{
+    enum ContactType { CONTACT_NONE, CONTACT_WALL, CONTACT_PADDLE_FACE, CONTACT_PADDLE_EDGE, CONTACT_OBSTACLE };
+    const int MAX_CONTACTS_PER_TICK = 4;
+
+    Ball &ball = sim->ball;
+    const Paddle *paddles[2] = { &sim->playerPaddle, &sim->computerPaddle };
+    const Level *level = GetLevel(sim->level);
+
+    ResolvePaddleOverlap(sim, sim->playerPaddle, SIDE_PLAYER);
+    ResolvePaddleOverlap(sim, sim->computerPaddle, SIDE_COMPUTER);
+
+    float remaining = 1.0f;     // Fraction of this tick's motion still to travel
+    for (int i = 0; i < MAX_CONTACTS_PER_TICK && remaining > 0; i++) {
+        float dx = ball.speedX * TICK_SCALE * remaining;
+        float dy = ball.speedY * TICK_SCALE * remaining;
+
+        ContactType contact = CONTACT_NONE;
+        CourtSide contactSide = SIDE_PLAYER;
+        float t = 1.0f;
+        float normalX = 0, normalY = 0;
+
+        // Top and bottom court boundaries, a ball already touching reflects immediately
+        if (dy < 0) {
+            float tw = (COURT_Y + ball.radius - ball.y) / dy;
+            if (tw < t) { t = (tw > 0) ? tw : 0; contact = CONTACT_WALL; }
+        } else if (dy > 0) {
+            float tw = (COURT_Y + COURT_HEIGHT - ball.radius - ball.y) / dy;
+            if (tw < t) { t = (tw > 0) ? tw : 0; contact = CONTACT_WALL; }
+        }
+
+        // Paddles, the court-facing side returns the ball and the ends deflect it
+        for (int side = 0; side < 2; side++) {
+            const Paddle &paddle = *paddles[side];
+            if (SweepCircleRect(ball.x, ball.y, dx, dy, ball.radius,
+                                paddle.x, paddle.y, paddle.width, paddle.height, &t, &normalX, &normalY)) {
+                float faceNormal = (side == SIDE_PLAYER) ? 1.0f : -1.0f;
+                contact = (normalX == faceNormal) ? CONTACT_PADDLE_FACE : CONTACT_PADDLE_EDGE;
+                contactSide = (CourtSide)side;
+            }
+        }
+
+        int contactObstacle = -1;
+        if (level->obstacleCount > 0) {
+            contactObstacle = SweepObstacles(sim, level, dx, dy, &t, &normalX, &normalY);
+            if (contactObstacle >= 0) contact = CONTACT_OBSTACLE;
+        }
+
+        ball.x += dx * t;
+        ball.y += dy * t;
+        if (contact == CONTACT_NONE) break;
+        remaining *= (1.0f - t);
+
+        switch (contact) {
+            case CONTACT_WALL:
+                ball.speedY *= -1;
+                InvalidatePredictions(sim);
+                PushEvent(sim, SIM_EVENT_WALL_HIT, contactSide);
+                break;
+            case CONTACT_PADDLE_FACE:
+                BounceOffPaddle(sim, *paddles[contactSide], contactSide);
+                break;
+            case CONTACT_PADDLE_EDGE: {
+                // Reflect off the paddle end, this doesn't count as a return
+                float dot = ball.speedX * normalX + ball.speedY * normalY;
+                ball.speedX -= 2 * dot * normalX;
+                ball.speedY -= 2 * dot * normalY;
+                InvalidatePredictions(sim);
+                PushEvent(sim, SIM_EVENT_WALL_HIT, contactSide);
+            } break;
+            case CONTACT_OBSTACLE:
+                BounceOffObstacle(sim, level, contactObstacle, normalX, normalY);
+                break;
+            default: break;
+        }
+    }
+}
+
+static void ScorePoint(PongSim *sim, CourtSide side)
+{
+    PushEvent(sim, SIM_EVENT_SCORE, side);
+
+    int *points = (side == SIDE_PLAYER) ? &sim->playerScore : &sim->computerScore;
+    (*points)++;
+    ServeBall(sim, (side == SIDE_PLAYER) ? -1 : 1);   // Serve to the side that lost the point
+    memset(sim->brokenBricks, 0, sizeof(sim->brokenBricks));    // Every point starts on a whole level
+
+    // Check for game over
+    if (*points >= WINNING_SCORE) sim->matchOver = true;
+}
+
+// Serve an extra ball from a random height, with some spread in speed so a crowd fans out
+static void ServeExtraBall(PongSim *sim, int i)
+{
+    BallSet &balls = sim->extraBalls;
+    PongRng *rng = &sim->extraBallRng;
+    float initialSpeed = sim->params.initialSpeed;
+
+    balls.x[i] = (float)COURT_X + COURT_WIDTH / 2;
+    balls.y[i] = (float)COURT_Y + COURT_HEIGHT / 4 + RngFloat(rng) * COURT_HEIGHT / 2;
+    balls.speedX[i] = initialSpeed * (0.6f + 0.6f * RngFloat(rng));
+    if (RngRange(rng, 0, 1) == 0) balls.speedX[i] = -balls.speedX[i];
+    balls.speedY[i] = initialSpeed * (2.0f * RngFloat(rng) - 1.0f);
+}
+
+// Per-tick constants for the extra ball step, shared by the SIMD and scalar paths
+struct ExtraBallStep {
+    float speedFactor, maxSpeed;
+    float paddleLeft[2], paddleRight[2];
+    float paddleTop[2], paddleBottom[2], paddleCenter[2];
+    float invHalfHeight[2];
+};
+
+// One extra ball, the reference for the SIMD loop: same operations in the same order, so
+// every ball ends up with the same bits whichever path stepped it
+static bool StepExtraBall(BallSet &balls, int i, const ExtraBallStep &step)
+{
+    float x = balls.x[i], y = balls.y[i];
+    float speedX = balls.speedX[i], speedY = balls.speedY[i];
+    float radius = balls.radius[i];
+
+    x = x + speedX * TICK_SCALE;
+    y = y + speedY * TICK_SCALE;
+
+    // Walls, reflecting the part of the move that went past them
+    float topLimit = COURT_Y + radius;
+    if (y < topLimit) { y = (topLimit + topLimit) - y; speedY = fabsf(speedY); }
+    float bottomLimit = (COURT_Y + COURT_HEIGHT) - radius;
+    if (y > bottomLimit) { y = (bottomLimit + bottomLimit) - y; speedY = -fabsf(speedY); }
+
+    // Paddles, same response as BounceOffPaddle() without the IMPOSSIBLE ramp
+    for (int side = 0; side < 2; side++) {
+        bool incoming = (side == SIDE_PLAYER) ? (speedX < 0) : (speedX > 0);
+        if (y > step.paddleTop[side] - radius && y < step.paddleBottom[side] + radius &&
+            x - radius < step.paddleRight[side] && x + radius > step.paddleLeft[side] && incoming) {
+            float hitPosition = (y - step.paddleCenter[side]) * step.invHalfHeight[side];
+            x = (side == SIDE_PLAYER) ? step.paddleRight[side] + radius : step.paddleLeft[side] - radius;
+            speedX = speedX * step.speedFactor;
+            speedY = speedY * 0.7f + hitPosition * 10.0f;
+        }
+    }
+
+    speedX = (speedX > -step.maxSpeed) ? speedX : -step.maxSpeed;
+    speedX = (speedX < step.maxSpeed) ? speedX : step.maxSpeed;
+    speedY = (speedY > -step.maxSpeed) ? speedY : -step.maxSpeed;
+    speedY = (speedY < step.maxSpeed) ? speedY : step.maxSpeed;
+
+    balls.x[i] = x;
+    balls.y[i] = y;
+    balls.speedX[i] = speedX;
+    balls.speedY[i] = speedY;
+
+    return (x - radius < COURT_X) || (x + radius > COURT_X + COURT_WIDTH);
+}
+
+// Push extra balls out of the obstacles they ended the tick in, one obstacle per ball per tick.
+// A discrete test like the paddles': every obstacle plus the smallest ball's diameter is wider
+// than a tick at the top speed, so no ball steps through one. Extra balls don't break bricks
+static void CollideExtraBalls(PongSim *sim, const Level *level)
+{
+    BallSet &balls = sim->extraBalls;
+    float tick = (float)sim->tick;
+
+    for (int i = 0; i < balls.count; i++) {
+        float x = balls.x[i], y = balls.y[i], radius = balls.radius[i];
+        LevelCellRange cells = GetLevelCells(x - radius, y - radius, x + radius, y + radius);
+        bool resolved = false;
+
+        for (int row = cells.row0; row <= cells.row1 && !resolved; row++) {
+            for (int column = cells.column0; column <= cells.column1 && !resolved; column++) {
+                int c = row * LEVEL_GRID_COLUMNS + column;
+                for (int k = level->cellStart[c]; k < level->cellStart[c + 1]; k++) {
+                    int index = level->cellItems[k];
+                    const Obstacle &obstacle = level->obstacles[index];
+                    if (obstacle.type == OBSTACLE_BRICK && IsBrickBroken(sim, index)) continue;
+
+                    // Closest point of the rectangle to the ball's center
+                    float top = GetObstacleY(&obstacle, tick);
+                    float nearX = fminf(fmaxf(x, obstacle.x), obstacle.x + obstacle.width);
+                    float nearY = fminf(fmaxf(y, top), top + obstacle.height);
+                    float offsetX = x - nearX, offsetY = y - nearY;
+                    float distanceSq = offsetX * offsetX + offsetY * offsetY;
+                    if (distanceSq >= radius * radius) continue;
+
+                    // Out along the surface normal, or along the nearest side when the center is inside
+                    float normalX, normalY;
+                    if (distanceSq > 0) {
+                        float distance = sqrtf(distanceSq);
+                        normalX = offsetX / distance;
+                        normalY = offsetY / distance;
+                        x = nearX + normalX * radius;
+                        y = nearY + normalY * radius;
+                    } else {
+                        float left = x - obstacle.x, right = obstacle.x + obstacle.width - x;
+                        float up = y - top, down = top + obstacle.height - y;
+                        float nearest = fminf(fminf(left, right), fminf(up, down));
+                        normalX = (nearest == left) ? -1.0f : ((nearest == right) ? 1.0f : 0.0f);
+                        normalY = (normalX != 0) ? 0.0f : ((nearest == up) ? -1.0f : 1.0f);
+                        if (normalX < 0) x = obstacle.x - radius;
+                        else if (normalX > 0) x = obstacle.x + obstacle.width + radius;
+                        else if (normalY < 0) y = top - radius;
+                        else y = top + obstacle.height + radius;
+                    }
+
+                    float speedX = balls.speedX[i], speedY = balls.speedY[i];
+                    float dot = speedX * normalX + speedY * normalY;
+                    if (dot < 0) {
+                        speedX -= 2 * dot * normalX;
+                        speedY -= 2 * dot * normalY;
+                        if (fabsf(speedX) < OBSTACLE_MIN_SPEED_X) speedX = copysignf(OBSTACLE_MIN_SPEED_X, speedX);
+                        if (obstacle.type == OBSTACLE_BUMPER) {
+                            float maxSpeed = sim->params.maxSpeed;
+                            speedX = fminf(fmaxf(speedX * BUMPER_KICK, -maxSpeed), maxSpeed);
+                            speedY = fminf(fmaxf(speedY * BUMPER_KICK, -maxSpeed), maxSpeed);
+                        }
+                    }
+                    balls.x[i] = x;
+                    balls.y[i] = y;
+                    balls.speedX[i] = speedX;
+                    balls.speedY[i] = speedY;
+                    resolved = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Advance every extra ball one tick, four at a time.
+// These skip the swept solver: a ball moves at most maxSpeed * TICK_SCALE per tick, less
+// than a paddle's width plus its diameter, so a discrete overlap test can't step past a paddle
+static void StepExtraBalls(PongSim *sim)
+{
+    BallSet &balls = sim->extraBalls;
+    const Paddle *paddles[2] = { &sim->playerPaddle, &sim->computerPaddle };
+
+    ExtraBallStep step;
+    step.speedFactor = sim->params.speedIncreaseFactor;
+    step.maxSpeed = sim->params.maxSpeed;
+    for (int side = 0; side < 2; side++) {
+        const Paddle &paddle = *paddles[side];
+        step.paddleLeft[side] = paddle.x;
+        step.paddleRight[side] = paddle.x + paddle.width;
+        step.paddleTop[side] = paddle.y;
+        step.paddleBottom[side] = paddle.y + paddle.height;
+        step.paddleCenter[side] = paddle.y + paddle.height / 2;
+        step.invHalfHeight[side] = 1.0f / (paddle.height / 2);
+    }
+
+    const Float4 tickScale = Splat4(TICK_SCALE);
+    const Float4 courtTop = Splat4((float)COURT_Y);
+    const Float4 courtBottom = Splat4((float)(COURT_Y + COURT_HEIGHT));
+    const Float4 courtLeft = Splat4((float)COURT_X);
+    const Float4 courtRight = Splat4((float)(COURT_X + COURT_WIDTH));
+    const Float4 zero = Splat4(0.0f);
+    const Float4 speedFactor = Splat4(step.speedFactor);
+    const Float4 maxSpeed = Splat4(step.maxSpeed);
+    const Float4 minSpeed = Splat4(-step.maxSpeed);
+    const Float4 damping = Splat4(0.7f);
+    const Float4 angle = Splat4(10.0f);
+
+    int i = 0;
+    for (; i + 4 <= balls.count; i += 4) {
+        Float4 x = Load4(balls.x + i), y = Load4(balls.y + i);
+        Float4 speedX = Load4(balls.speedX + i), speedY = Load4(balls.speedY + i);
+        Float4 radius = Load4(balls.radius + i);
+
+        x = Add4(x, Mul4(speedX, tickScale));
+        y = Add4(y, Mul4(speedY, tickScale));
+
+        Float4 topLimit = Add4(courtTop, radius);
+        Float4 hitTop = Less4(y, topLimit);
+        y = Select4(hitTop, Sub4(Add4(topLimit, topLimit), y), y);
+        speedY = Select4(hitTop, Abs4(speedY), speedY);
+
+        Float4 bottomLimit = Sub4(courtBottom, radius);
+        Float4 hitBottom = Greater4(y, bottomLimit);
+        y = Select4(hitBottom, Sub4(Add4(bottomLimit, bottomLimit), y), y);
+        speedY = Select4(hitBottom, Neg4(Abs4(speedY)), speedY);
+
+        for (int side = 0; side < 2; side++) {
+            Float4 paddleLeft = Splat4(step.paddleLeft[side]);
+            Float4 paddleRight = Splat4(step.paddleRight[side]);
+            Float4 incoming = (side == SIDE_PLAYER) ? Less4(speedX, zero) : Greater4(speedX, zero);
+            Float4 hit = And4(Greater4(y, Sub4(Splat4(step.paddleTop[side]), radius)),
+                              Less4(y, Add4(Splat4(step.paddleBottom[side]), radius)));
+            hit = And4(hit, Less4(Sub4(x, radius), paddleRight));
+            hit = And4(hit, Greater4(Add4(x, radius), paddleLeft));
+            hit = And4(hit, incoming);
+
+            Float4 hitPosition = Mul4(Sub4(y, Splat4(step.paddleCenter[side])), Splat4(step.invHalfHeight[side]));
+            Float4 faceX = (side == SIDE_PLAYER) ? Add4(paddleRight, radius) : Sub4(paddleLeft, radius);
+            x = Select4(hit, faceX, x);
+            speedX = Select4(hit, Mul4(speedX, speedFactor), speedX);
+            speedY = Select4(hit, Add4(Mul4(speedY, damping), Mul4(hitPosition, angle)), speedY);
+        }
+
+        speedX = Min4(Max4(speedX, minSpeed), maxSpeed);
+        speedY = Min4(Max4(speedY, minSpeed), maxSpeed);
+
+        Store4(balls.x + i, x);
+        Store4(balls.y + i, y);
+        Store4(balls.speedX + i, speedX);
+        Store4(balls.speedY + i, speedY);
+
+        // Leaving the court is rare, serve those lanes again one by one
+        int out = MaskBits4(Or4(Less4(Sub4(x, radius), courtLeft), Greater4(Add4(x, radius), courtRight)));
+        for (int lane = 0; out != 0; lane++, out >>= 1) {
+            if (out & 1) ServeExtraBall(sim, i + lane);
+        }
+    }
+
+    for (; i < balls.count; i++) {
+        if (StepExtraBall(balls, i, step)) ServeExtraBall(sim, i);
+    }
+
+    const Level *level = GetLevel(sim->level);
+    if (level->obstacleCount > 0) CollideExtraBalls(sim, level);
+}
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+DifficultyParams GetDifficultyParams(DifficultyLevel difficulty)
+{
+    DifficultyParams params = {};
+
+    switch (difficulty) {
+        case EASY:
+            params.initialSpeed = 7.0f;             // Reduced for more manageable gameplay
+            params.speedIncreaseFactor = -1.02f;    // Increased from -1.01f for better gameplay at 60 FPS
+            params.maxSpeed = 18.0f;                // Reduced for more controllable gameplay
+            params.ai = (AIParams){ 0.5f, 0.5f, 35.0f, 8.5f, false, 0.0f };
+            break;
+        case MEDIUM:
+            params.initialSpeed = 10.0f;            // Adjusted for proper medium challenge
+            params.speedIncreaseFactor = -1.04f;    // Increased from -1.02f for better gameplay at 60 FPS
+            params.maxSpeed = 24.0f;                // Reduced for more controllable gameplay
+            params.ai = (AIParams){ 0.65f, 0.55f, 40.0f, 12.0f, false, 0.0f };
+            break;
+        case HARD:
+            params.initialSpeed = 14.0f;            // Adjusted for better game feel
+            params.speedIncreaseFactor = -1.06f;    // Increased from -1.03f for better gameplay at 60 FPS
+            params.maxSpeed = 32.0f;                // Reduced for more controllable gameplay
+            params.ai = (AIParams){ 0.75f, 0.75f, 30.0f, 15.0f, false, 20.0f };
+            break;
+        case IMPOSSIBLE:
+            params.initialSpeed = 18.0f;            // Still challenging but more reasonable
+            params.speedIncreaseFactor = -1.08f;    // Increased from -1.06f for better gameplay at 60 FPS
+            params.maxSpeed = 45.0f;                // Reduced but still very challenging
+            params.speedRamp = true;
+            params.ai = (AIParams){ 1.0f, 1.0f, 5.0f, 24.0f, true, 0.0f };
+            break;
+    }
+
+    return params;
+}
+
+void InitPongSim(PongSim *sim, DifficultyLevel difficulty, uint64_t seed)
+{
+    memset(sim, 0, sizeof(PongSim));
+
+    sim->difficulty = difficulty;
+    sim->params = GetDifficultyParams(difficulty);
+    sim->ai[SIDE_PLAYER] = sim->params.ai;
+    sim->ai[SIDE_COMPUTER] = sim->params.ai;
+
+    sim->controllers[SIDE_PLAYER] = CONTROLLER_HUMAN;
+    sim->controllers[SIDE_COMPUTER] = CONTROLLER_AI;
+
+    StartPongSimMatch(sim, seed);
+}
+
+void StartPongSimMatch(PongSim *sim, uint64_t seed)
+{
+    // Everything random in a match comes from this stream, so the seed and the
+    // inputs are enough to reproduce it exactly
+    sim->seed = seed;
+    SeedRng(&sim->rng, seed);
+
+    // Initialize Paddles
+    sim->playerPaddle = (Paddle){ COURT_X + 20, SCREEN_HEIGHT / 2 - 60, 20, 120, 0 };
+    sim->computerPaddle = (Paddle){ COURT_X + COURT_WIDTH - 40, SCREEN_HEIGHT / 2 - 60, 20, 120, 0 };
+
+    // Initialize Ball
+    sim->ball = (Ball){ (float)COURT_X + COURT_WIDTH / 2, (float)COURT_Y + COURT_HEIGHT / 2, 7, 7, 15, 1.0f, 0 };
+
+    sim->playerScore = 0;
+    sim->computerScore = 0;
+    sim->matchOver = false;
+    sim->tick = 0;
+    memset(sim->brokenBricks, 0, sizeof(sim->brokenBricks));
+    ServeBall(sim, 0);
+    SetPongSimExtraBalls(sim, sim->extraBalls.count);
+}
+
+void ServeBall(PongSim *sim, int direction)
+{
+    Ball &ball = sim->ball;
+    float initialSpeed = sim->params.initialSpeed;
+
+    ball.x = (float)COURT_X + COURT_WIDTH / 2;
+    ball.y = (float)COURT_Y + COURT_HEIGHT / 2;
+    ball.hitCounter = 0;
+    ball.impossibleSpeedMultiplier = 1.0f;
+
+    if (direction == 0) {
+        ball.speedX = (RngRange(&sim->rng, 0, 1) == 0) ? -initialSpeed : initialSpeed;
+    } else {
+        ball.speedX = initialSpeed * direction;
+    }
+    ball.speedY = (RngRange(&sim->rng, 0, 1) == 0) ? -initialSpeed : initialSpeed;
+
+    InvalidatePredictions(sim);
+}
+
+void SetPongSimExtraBalls(PongSim *sim, int count)
+{
+    if (count < 0) count = 0;
+    if (count > SIM_MAX_BALLS) count = SIM_MAX_BALLS;
+
+    // Derived from the match seed and reseeded on every change, so the balls only depend
+    // on the seed and the final count, however often the mode was toggled before play
+    BallSet &balls = sim->extraBalls;
+    SeedRng(&sim->extraBallRng, sim->seed ^ 0xB0A11B0A11ULL);
+    balls.count = count;
+    for (int i = 0; i < count; i++) {
+        balls.radius[i] = (float)RngRange(&sim->extraBallRng, 6, 10);
+        ServeExtraBall(sim, i);
+    }
+}
+
+void SetPongSimLevel(PongSim *sim, int level)
+{
+    sim->level = (level >= 0 && level < LEVEL_COUNT) ? level : LEVEL_CLASSIC;
+    memset(sim->brokenBricks, 0, sizeof(sim->brokenBricks));
+}
+
+// Everything but the extra ball arrays and the broken bricks is copied as is. Of the arrays only
+// the first count entries go in, and of the bitset only the words the level's obstacles use, so a
+// single-ball snapshot on the bare court is a few hundred bytes instead of the full struct.
+// The events are the last step's output, rebuilt by every StepPongSim(), so they're left out
+static const size_t SNAPSHOT_HEAD_SIZE = offsetof(PongSim, extraBalls);
+static const size_t SNAPSHOT_TAIL_OFFSET = offsetof(PongSim, level);
+static const size_t SNAPSHOT_TAIL_SIZE = offsetof(PongSim, events) - SNAPSHOT_TAIL_OFFSET;
+
+int SavePongSimSnapshot(const PongSim *sim, unsigned char *buffer)
+{
+    const BallSet &balls = sim->extraBalls;
+    size_t arraySize = balls.count * sizeof(float);
+    unsigned char *p = buffer;
+
+    memcpy(p, sim, SNAPSHOT_HEAD_SIZE); p += SNAPSHOT_HEAD_SIZE;
+    memcpy(p, &balls.count, sizeof(int)); p += sizeof(int);
+    memcpy(p, balls.x, arraySize); p += arraySize;
+    memcpy(p, balls.y, arraySize); p += arraySize;
+    memcpy(p, balls.speedX, arraySize); p += arraySize;
+    memcpy(p, balls.speedY, arraySize); p += arraySize;
+    memcpy(p, balls.radius, arraySize); p += arraySize;
+    int brickWords = (GetLevel(sim->level)->obstacleCount + 31) / 32;
+    memcpy(p, &brickWords, sizeof(int)); p += sizeof(int);
+    memcpy(p, sim->brokenBricks, brickWords * sizeof(uint32_t)); p += brickWords * sizeof(uint32_t);
+    memcpy(p, (const unsigned char *)sim + SNAPSHOT_TAIL_OFFSET, SNAPSHOT_TAIL_SIZE); p += SNAPSHOT_TAIL_SIZE;
+
+    return (int)(p - buffer);
+}
+
+void LoadPongSimSnapshot(PongSim *sim, const unsigned char *buffer)
+{
+    BallSet &balls = sim->extraBalls;
+    const unsigned char *p = buffer;
+
+    memcpy(sim, p, SNAPSHOT_HEAD_SIZE); p += SNAPSHOT_HEAD_SIZE;
+    memcpy(&balls.count, p, sizeof(int)); p += sizeof(int);
+    size_t arraySize = balls.count * sizeof(float);
+    memcpy(balls.x, p, arraySize); p += arraySize;
+    memcpy(balls.y, p, arraySize); p += arraySize;
+    memcpy(balls.speedX, p, arraySize); p += arraySize;
+    memcpy(balls.speedY, p, arraySize); p += arraySize;
+    memcpy(balls.radius, p, arraySize); p += arraySize;
+    int brickWords;
+    memcpy(&brickWords, p, sizeof(int)); p += sizeof(int);
+    memcpy(sim->brokenBricks, p, brickWords * sizeof(uint32_t)); p += brickWords * sizeof(uint32_t);
+    memcpy((unsigned char *)sim + SNAPSHOT_TAIL_OFFSET, p, SNAPSHOT_TAIL_SIZE);
+}
+
+float PredictBallY(const Ball *ball, float targetX, bool bounceOffWalls)
+{
+    if (ball->speedX == 0) return ball->y;
+
+    float timeToReach = (targetX - ball->x) / ball->speedX;
+    float y = ball->y + ball->speedY * timeToReach;
+
+    return bounceOffWalls ? FoldCourtY(y, ball->radius) : y;
+}
+
+float FoldCourtY(float y, float radius)
+{
+    // Wall bounces mirror the ball's path, so the straight-line position folds back into
+    // the court as a triangle wave with a period of twice the playable height
+    float low = COURT_Y + radius;
+    float span = COURT_HEIGHT - 2 * radius;
+    if (span <= 0) return low;
+
+    float period = 2 * span;
+    float offset = fmodf(y - low, period);
+    if (offset < 0) offset += period;
+    if (offset > span) offset = period - offset;
+
+    return low + offset;
+}
+
+void StepHumanPaddle(Paddle *paddle, bool moveUp, bool moveDown)
+{
+    UpdateHumanPaddle(paddle, moveUp, moveDown);
+}
+
+void StepPongSim(PongSim *sim, unsigned int input)
+{
+    Ball &ball = sim->ball;
+    Paddle &playerPaddle = sim->playerPaddle;
+    Paddle &computerPaddle = sim->computerPaddle;
+
+    sim->eventCount = 0;
+    if (sim->matchOver) return;
+    sim->tick++;
+
+    // Move paddles
+    if (sim->controllers[SIDE_PLAYER] == CONTROLLER_HUMAN) {
+        UpdateHumanPaddle(&playerPaddle, (input & INPUT_PLAYER_UP) != 0, (input & INPUT_PLAYER_DOWN) != 0);
+    } else {
+        UpdateAIPaddle(sim, SIDE_PLAYER);
+    }
+    if (sim->controllers[SIDE_COMPUTER] == CONTROLLER_HUMAN) {
+        UpdateHumanPaddle(&computerPaddle, (input & INPUT_COMPUTER_UP) != 0, (input & INPUT_COMPUTER_DOWN) != 0);
+    } else {
+        UpdateAIPaddle(sim, SIDE_COMPUTER);
+    }
+
+    // Move the ball, resolving every wall and paddle contact along the way
+    MoveBall(sim);
+
+    // Score points when ball passes paddles (using court boundaries)
+    if (ball.x - ball.radius < COURT_X) {
+        ScorePoint(sim, SIDE_COMPUTER);
+    }
+    if (ball.x + ball.radius > COURT_X + COURT_WIDTH) {
+        ScorePoint(sim, SIDE_PLAYER);
+    }
+
+    // Cap ball speed - different caps for different difficulty levels
+    ClampBallSpeed(sim);
+
+    if (sim->extraBalls.count > 0) StepExtraBalls(sim);
+}
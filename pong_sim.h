@@ -0,0 +1,176 @@
+#ifndef PONG_SIM_H
+#define PONG_SIM_H
+
+//----------------------------------------------------------------------------------
+// Headless ping pong simulation: rally physics, scoring and paddle AI
+// Plain C++ with no raylib dependency, so it runs without a window or audio device
+//----------------------------------------------------------------------------------
+#include <cstdint>
+
+#include "pong_rng.h"
+
+static const int SCREEN_WIDTH = 1024;
+static const int SCREEN_HEIGHT = 768;
+
+// Constants for the court area - with a border
+static const int COURT_BORDER_X = 5;
+static const int COURT_BORDER_Y = 75;
+static const int COURT_X = COURT_BORDER_X;
+static const int COURT_Y = COURT_BORDER_Y;
+static const int COURT_WIDTH = SCREEN_WIDTH - (2 * COURT_BORDER_X);
+static const int COURT_HEIGHT = SCREEN_HEIGHT - (2 * COURT_BORDER_Y);
+
+// Fixed-timestep simulation
+// Speeds and tuning values are expressed in pixels per 60 Hz frame, TICK_SCALE converts them to one tick
+static const int SIM_TICK_RATE = 120;
+static const float SIM_DT = 1.0f / SIM_TICK_RATE;
+static const float TICK_SCALE = 60.0f / SIM_TICK_RATE;
+
+static const int WINNING_SCORE = 10;
+static const int SIM_MAX_EVENTS = 8;
+static const int SIM_MAX_BALLS = 512;   // Extra balls in multi-ball mode, a multiple of the SIMD width
+static const int LEVEL_MAX_OBSTACLES = 4096;    // Per level, see level.h
+
+// Structure for the paddles
+struct Paddle {
+    float x, y;
+    float width, height;
+    float velocityY; // For smooth movement
+};
+
+// Structure for the ball
+struct Ball {
+    float x, y;
+    float speedX, speedY;
+    float radius;
+    float impossibleSpeedMultiplier; // Speed multiplier for IMPOSSIBLE mode
+    int hitCounter;                 // Track consecutive hits for IMPOSSIBLE mode
+};
+
+// Extra balls for multi-ball mode, stored as structure-of-arrays so the physics step
+// handles four balls per SIMD instruction. They bounce off walls and paddles but don't
+// score, a ball leaving the court is served again from the center
+struct BallSet {
+    alignas(16) float x[SIM_MAX_BALLS];
+    alignas(16) float y[SIM_MAX_BALLS];
+    alignas(16) float speedX[SIM_MAX_BALLS];
+    alignas(16) float speedY[SIM_MAX_BALLS];
+    alignas(16) float radius[SIM_MAX_BALLS];
+    int count;
+};
+
+// Difficulty levels
+enum DifficultyLevel {
+    EASY,
+    MEDIUM,
+    HARD,
+    IMPOSSIBLE
+};
+
+// Court sides, the player is on the left and the computer on the right
+enum CourtSide {
+    SIDE_PLAYER = 0,
+    SIDE_COMPUTER = 1
+};
+
+// Who drives a paddle
+enum PaddleController {
+    CONTROLLER_HUMAN,
+    CONTROLLER_AI
+};
+
+// Per-tick input bits, only read for paddles driven by CONTROLLER_HUMAN
+enum SimInputFlags {
+    INPUT_PLAYER_UP = 1 << 0,
+    INPUT_PLAYER_DOWN = 1 << 1,
+    INPUT_COMPUTER_UP = 1 << 2,
+    INPUT_COMPUTER_DOWN = 1 << 3
+};
+
+// Computer AI tuning
+struct AIParams {
+    float accuracy;             // Chance per tick of moving correctly
+    float reactionSpeed;        // Paddle speed multiplier
+    float deadZone;             // Area where paddle won't react
+    float paddleSpeed;          // Paddle speed in pixels per 60 Hz frame
+    bool advancedPrediction;    // Predict wall bounces
+    float predictionError;      // Random error added to advanced predictions, in pixels
+};
+
+// Ball tuning for a difficulty level
+struct DifficultyParams {
+    float initialSpeed;         // Serve speed on both axes
+    float speedIncreaseFactor;  // Applied to speedX on every paddle hit
+    float maxSpeed;             // Cap for both speed axes
+    bool speedRamp;             // Ramp impossibleSpeedMultiplier after a few hits
+    AIParams ai;
+};
+
+// Things that happened during a tick, for sound and visual feedback
+enum SimEventType {
+    SIM_EVENT_WALL_HIT,
+    SIM_EVENT_PADDLE_HIT,
+    SIM_EVENT_SCORE,
+    SIM_EVENT_OBSTACLE_HIT
+};
+
+struct SimEvent {
+    SimEventType type;
+    CourtSide side;             // Paddle that was hit, or side that scored
+    float x, y;                 // Ball position when it happened
+    float speedX, speedY;       // Ball velocity right after it
+    float hitPosition;          // PADDLE_HIT: where the ball met the paddle, -1 top end to 1 bottom end
+    bool speedClamped;          // PADDLE_HIT: the return was held to params.maxSpeed
+    int obstacle;               // OBSTACLE_HIT: index into the level's obstacles, -1 otherwise
+    unsigned int tick;
+};
+
+// Complete simulation state, plain data so it can be copied as a snapshot
+struct PongSim {
+    DifficultyLevel difficulty;
+    DifficultyParams params;
+    AIParams ai[2];                     // Indexed by CourtSide
+    PaddleController controllers[2];    // Indexed by CourtSide
+
+    Paddle playerPaddle;
+    Paddle computerPaddle;
+    Ball ball;
+    BallSet extraBalls;
+    uint32_t brokenBricks[LEVEL_MAX_OBSTACLES / 32];    // Bit per obstacle index, cleared after every point
+
+    int level;                          // LevelId
+    int playerScore;
+    int computerScore;
+    bool matchOver;
+    unsigned int tick;
+
+    uint64_t seed;                      // Seed the current match started from
+    PongRng rng;                        // Gameplay random stream, only the simulation draws from it
+    PongRng extraBallRng;               // Separate stream for extra balls, so they never shift the main one
+
+    bool predictionValid[2];            // AI intercept cache, cleared whenever the ball's path changes
+    float predictedY[2];
+
+    // Output of the last StepPongSim() call, not part of a snapshot. Keep these last
+    SimEvent events[SIM_MAX_EVENTS];
+    int eventCount;
+};
+
+// Upper bound for SavePongSimSnapshot(), the snapshot skips the unused tail of the extra ball arrays,
+// the bitset words past the level's obstacles and the events
+static const int PONG_SIM_SNAPSHOT_MAX = (int)sizeof(PongSim);
+
+DifficultyParams GetDifficultyParams(DifficultyLevel difficulty);  // Tuning table for a difficulty level
+void InitPongSim(PongSim *sim, DifficultyLevel difficulty, uint64_t seed);  // Apply difficulty tuning, player vs computer AI, start a match
+void StartPongSimMatch(PongSim *sim, uint64_t seed);              // Reset paddles, ball and scores, reseed and serve
+void ServeBall(PongSim *sim, int direction);                      // direction: 0 = random, 1 = to player, -1 = to computer
+void SetPongSimExtraBalls(PongSim *sim, int count);               // Multi-ball mode, 0 turns it off, up to SIM_MAX_BALLS
+void SetPongSimLevel(PongSim *sim, int level);                    // Obstacles for the match, LEVEL_CLASSIC for none
+void StepPongSim(PongSim *sim, unsigned int input);               // Advance one fixed tick
+void StepHumanPaddle(Paddle *paddle, bool moveUp, bool moveDown);  // One tick of human paddle movement, as StepPongSim() does it
+int SavePongSimSnapshot(const PongSim *sim, unsigned char *buffer);  // Compact copy for rollback, returns bytes written
+void LoadPongSimSnapshot(PongSim *sim, const unsigned char *buffer); // Restore a SavePongSimSnapshot() copy, the events stay as they were
+float PredictBallY(const Ball *ball, float targetX, bool bounceOffWalls); // Ball center Y when it reaches targetX, O(1)
+float FoldCourtY(float y, float radius);                          // Fold an unbounded Y into the court, as wall bounces would
+
+#endif // PONG_SIM_H
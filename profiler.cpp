@@ -0,0 +1,203 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+//----------------------------------------------------------------------------------
+// Profiler state
+//----------------------------------------------------------------------------------
+static const int PROFILE_MAX_EVENTS = 32768;    // Zone events kept for the trace, oldest dropped first
+static const int PROFILE_MAX_DEPTH = 16;
+
+static const char *zoneNames[PROFILE_ZONE_COUNT] = {
+    "input", "sim", "starfield", "particles",
+    "draw_background", "draw_menu", "draw_difficulty", "draw_ready", "draw_gameplay", "draw_game_over",
+    "postfx", "present"
+};
+
+struct ProfileFrame {
+    float frameMs;
+    float zoneMs[PROFILE_ZONE_COUNT];
+    int drawCalls, vertices;
+};
+
+struct ProfileEvent {
+    int zone;                   // PROFILE_ZONE_COUNT marks a whole frame
+    int64_t startNs, durationNs;
+};
+
+struct OpenZone {
+    int zone;
+    int64_t startNs;
+    int64_t childNs;            // Time spent in nested zones
+};
+
+thread_local bool profilerRecording = false;
+static bool pendingEnabled = false;
+
+static ProfileFrame frames[PROFILE_HISTORY];
+static int frameCount = 0;      // Valid entries, up to PROFILE_HISTORY
+static int frameNext = 0;
+static ProfileFrame current;
+static int64_t frameStartNs = -1;
+
+static ProfileEvent events[PROFILE_MAX_EVENTS];
+static int eventCount = 0;
+static int eventNext = 0;
+
+static OpenZone stack[PROFILE_MAX_DEPTH];
+static int depth = 0;
+
+static int64_t NowNs(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void PushEvent(int zone, int64_t startNs, int64_t durationNs)
+{
+    events[eventNext] = (ProfileEvent){ zone, startNs, durationNs };
+    eventNext = (eventNext + 1) % PROFILE_MAX_EVENTS;
+    if (eventCount < PROFILE_MAX_EVENTS) eventCount++;
+}
+
+//----------------------------------------------------------------------------------
+// Module functions
+//----------------------------------------------------------------------------------
+void SetProfilerEnabled(bool enable)
+{
+    pendingEnabled = enable;
+}
+
+bool IsProfilerEnabled(void)
+{
+    return pendingEnabled;
+}
+
+void BeginProfileFrame(void)
+{
+    int64_t now = NowNs();
+
+    if (profilerRecording && frameStartNs >= 0) {
+        current.frameMs = (now - frameStartNs) / 1e6f;
+        frames[frameNext] = current;
+        frameNext = (frameNext + 1) % PROFILE_HISTORY;
+        if (frameCount < PROFILE_HISTORY) frameCount++;
+        PushEvent(PROFILE_ZONE_COUNT, frameStartNs, now - frameStartNs);
+    }
+
+    // Enabling only at a frame boundary keeps zones balanced
+    if (pendingEnabled != profilerRecording) {
+        profilerRecording = pendingEnabled;
+        frameCount = frameNext = 0;
+        eventCount = eventNext = 0;
+    }
+
+    memset(&current, 0, sizeof(current));
+    depth = 0;
+    frameStartNs = profilerRecording ? now : -1;
+}
+
+void SetProfileDrawStats(int drawCalls, int vertices)
+{
+    current.drawCalls = drawCalls;
+    current.vertices = vertices;
+}
+
+bool BeginProfileZone(ProfileZone zone)
+{
+    if (!profilerRecording || depth >= PROFILE_MAX_DEPTH) return false;
+    stack[depth++] = (OpenZone){ zone, NowNs(), 0 };
+    return true;
+}
+
+void EndProfileZone(void)
+{
+    if (depth <= 0) return;
+    OpenZone &open = stack[--depth];
+    int64_t duration = NowNs() - open.startNs;
+
+    current.zoneMs[open.zone] += (duration - open.childNs) / 1e6f;
+    if (depth > 0) stack[depth - 1].childNs += duration;
+    PushEvent(open.zone, open.startNs, duration);
+}
+
+ProfileStats GetProfileStats(void)
+{
+    ProfileStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.frames = frameCount;
+    if (frameCount == 0) return stats;
+
+    float sorted[PROFILE_HISTORY];
+    float total = 0.0f;
+    for (int i = 0; i < frameCount; i++) {
+        sorted[i] = frames[i].frameMs;
+        total += frames[i].frameMs;
+        for (int z = 0; z < PROFILE_ZONE_COUNT; z++) stats.zoneMs[z] += frames[i].zoneMs[z];
+    }
+    std::sort(sorted, sorted + frameCount);
+
+    stats.minMs = sorted[0];
+    stats.avgMs = total / frameCount;
+    stats.p99Ms = sorted[(frameCount - 1) * 99 / 100];
+    for (int z = 0; z < PROFILE_ZONE_COUNT; z++) stats.zoneMs[z] /= frameCount;
+
+    const ProfileFrame &last = frames[(frameNext + PROFILE_HISTORY - 1) % PROFILE_HISTORY];
+    stats.drawCalls = last.drawCalls;
+    stats.vertices = last.vertices;
+    return stats;
+}
+
+int GetProfileFrameTimes(float *frameMs, int maxCount)
+{
+    int count = std::min(maxCount, frameCount);
+    for (int i = 0; i < count; i++) {
+        frameMs[i] = frames[(frameNext - count + i + PROFILE_HISTORY) % PROFILE_HISTORY].frameMs;
+    }
+    return count;
+}
+
+const char *GetProfileZoneName(ProfileZone zone)
+{
+    return zoneNames[zone];
+}
+
+bool SaveProfileCsv(const char *fileName)
+{
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL) return false;
+
+    fprintf(file, "frame,frame_ms,draw_calls,vertices");
+    for (int z = 0; z < PROFILE_ZONE_COUNT; z++) fprintf(file, ",%s_ms", zoneNames[z]);
+    fprintf(file, "\n");
+
+    for (int i = 0; i < frameCount; i++) {
+        const ProfileFrame &frame = frames[(frameNext - frameCount + i + PROFILE_HISTORY) % PROFILE_HISTORY];
+        fprintf(file, "%d,%.4f,%d,%d", i, frame.frameMs, frame.drawCalls, frame.vertices);
+        for (int z = 0; z < PROFILE_ZONE_COUNT; z++) fprintf(file, ",%.4f", frame.zoneMs[z]);
+        fprintf(file, "\n");
+    }
+
+    return fclose(file) == 0;
+}
+
+bool SaveProfileTrace(const char *fileName)
+{
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL) return false;
+
+    // Complete ("X") events in microseconds, the viewer rebuilds nesting from the time ranges
+    fprintf(file, "{\"traceEvents\":[\n");
+    for (int i = 0; i < eventCount; i++) {
+        const ProfileEvent &event = events[(eventNext - eventCount + i + PROFILE_MAX_EVENTS) % PROFILE_MAX_EVENTS];
+        const char *name = (event.zone == PROFILE_ZONE_COUNT) ? "frame" : zoneNames[event.zone];
+        fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+            name, event.startNs / 1e3, event.durationNs / 1e3, (i + 1 < eventCount) ? "," : "");
+    }
+    fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+
+    return fclose(file) == 0;
+}
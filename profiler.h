@@ -0,0 +1,61 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+//----------------------------------------------------------------------------------
+// Frame profiler: scoped CPU timers per phase, rolling frame-time stats and
+// CSV / Chrome trace dumps (open the trace in chrome://tracing or Perfetto)
+// No raylib dependency, the simulation times itself through it as well
+// Scopes nest, per-zone times are self time with nested zones subtracted
+//----------------------------------------------------------------------------------
+
+enum ProfileZone {
+    PROFILE_INPUT,              // State update and input handling
+    PROFILE_SIM,                // Simulation ticks: paddles, AI, ball, collisions and scoring
+    PROFILE_STARFIELD,          // Starfield update
+    PROFILE_PARTICLES,          // Particle update
+    PROFILE_DRAW_BACKGROUND,    // Stars and court
+    PROFILE_DRAW_MENU,
+    PROFILE_DRAW_DIFFICULTY,
+    PROFILE_DRAW_READY,
+    PROFILE_DRAW_GAMEPLAY,      // GAMEPLAY and PAUSED
+    PROFILE_DRAW_GAME_OVER,
+    PROFILE_POSTFX,             // Post-process pass
+    PROFILE_PRESENT,            // Buffer swap, vsync wait and event polling
+    PROFILE_ZONE_COUNT
+};
+
+static const int PROFILE_HISTORY = 600;        // Frames kept for stats, the graph and the CSV
+
+struct ProfileStats {
+    float minMs, avgMs, p99Ms;                  // Frame time over the history
+    float zoneMs[PROFILE_ZONE_COUNT];           // Average self time per frame
+    int drawCalls, vertices;                    // Last frame
+    int frames;                                 // Frames in the history
+};
+
+void SetProfilerEnabled(bool enabled);          // Takes effect at the next BeginProfileFrame()
+bool IsProfilerEnabled(void);
+void BeginProfileFrame(void);                   // Closes the previous frame's record
+void SetProfileDrawStats(int drawCalls, int vertices);  // Render stats for the current frame
+
+bool BeginProfileZone(ProfileZone zone);        // False when profiling is off
+void EndProfileZone(void);
+
+// Read inline by ProfileScope, so disabled scopes cost only a branch. Per thread, only the thread
+// running BeginProfileFrame() records, a simulation thread's zones stay off instead of racing it
+extern thread_local bool profilerRecording;
+
+ProfileStats GetProfileStats(void);
+int GetProfileFrameTimes(float *frameMs, int maxCount);     // Most recent frames, oldest first
+const char *GetProfileZoneName(ProfileZone zone);
+bool SaveProfileCsv(const char *fileName);      // One row per frame in the history
+bool SaveProfileTrace(const char *fileName);    // Chrome trace event JSON of the most recent zones
+
+// Times the enclosing block
+struct ProfileScope {
+    bool active;
+    explicit ProfileScope(ProfileZone zone) : active(profilerRecording && BeginProfileZone(zone)) {}
+    ~ProfileScope() { if (active) EndProfileZone(); }
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,174 @@
+#include "replay.h"
+#include "level.h"
+
+#include <cstdio>
+#include <cstring>
+
+//----------------------------------------------------------------------------------
+// Little-endian helpers, so files move between platforms
+//----------------------------------------------------------------------------------
+static void PutU16(unsigned char *p, uint32_t v) { p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; }
+static void PutU32(unsigned char *p, uint32_t v) { PutU16(p, v & 0xFFFF); PutU16(p + 2, v >> 16); }
+static void PutU64(unsigned char *p, uint64_t v) { PutU32(p, (uint32_t)v); PutU32(p + 4, (uint32_t)(v >> 32)); }
+static uint32_t GetU16(const unsigned char *p) { return p[0] | (p[1] << 8); }
+static uint32_t GetU32(const unsigned char *p) { return GetU16(p) | (GetU16(p + 2) << 16); }
+static uint64_t GetU64(const unsigned char *p) { return GetU32(p) | ((uint64_t)GetU32(p + 4) << 32); }
+
+static const int REPLAY_HEADER_SIZE_V1 = 20;
+static const int REPLAY_HEADER_SIZE = 24;
+
+//----------------------------------------------------------------------------------
+// Recording
+//----------------------------------------------------------------------------------
+void BeginReplayRecording(Replay *replay, uint64_t seed, DifficultyLevel difficulty)
+{
+    replay->seed = seed;
+    replay->difficulty = difficulty;
+    replay->extraBalls = 0;
+    replay->level = LEVEL_CLASSIC;
+    replay->tickCount = 0;
+    replay->inputs.clear();
+}
+
+void RecordReplayTick(Replay *replay, unsigned int input)
+{
+    input &= 0x0F;
+    if (replay->tickCount % 2 == 0) replay->inputs.push_back((unsigned char)input);
+    else replay->inputs.back() |= (unsigned char)(input << 4);
+    replay->tickCount++;
+}
+
+unsigned int GetReplayInput(const Replay *replay, int tick)
+{
+    unsigned char packed = replay->inputs[tick / 2];
+    return (tick % 2 == 0) ? (packed & 0x0F) : (packed >> 4);
+}
+
+bool SaveReplay(const Replay *replay, const char *fileName)
+{
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL) return false;
+
+    unsigned char header[REPLAY_HEADER_SIZE];
+    memcpy(header, "PPRP", 4);
+    PutU16(header + 4, REPLAY_VERSION);
+    header[6] = (unsigned char)replay->difficulty;
+    header[7] = (unsigned char)replay->level;
+    PutU64(header + 8, replay->seed);
+    PutU32(header + 16, (uint32_t)replay->tickCount);
+    PutU16(header + 20, (uint32_t)replay->extraBalls);
+    PutU16(header + 22, 0);
+
+    bool ok = (fwrite(header, 1, sizeof(header), file) == sizeof(header));
+    if (ok && !replay->inputs.empty()) {
+        ok = (fwrite(replay->inputs.data(), 1, replay->inputs.size(), file) == replay->inputs.size());
+    }
+    if (fclose(file) != 0) ok = false;
+    return ok;
+}
+
+// Bytes between the read position and the end of the file
+static long RemainingBytes(FILE *file)
+{
+    long position = ftell(file);
+    if (position < 0 || fseek(file, 0, SEEK_END) != 0) return 0;
+    long end = ftell(file);
+    fseek(file, position, SEEK_SET);
+    return (end > position) ? end - position : 0;
+}
+
+bool LoadReplay(Replay *replay, const char *fileName)
+{
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) return false;
+
+    unsigned char header[REPLAY_HEADER_SIZE] = { 0 };
+    bool ok = (fread(header, 1, REPLAY_HEADER_SIZE_V1, file) == (size_t)REPLAY_HEADER_SIZE_V1) &&
+              (memcmp(header, "PPRP", 4) == 0) &&
+              (GetU16(header + 4) >= 1) && (GetU16(header + 4) <= (uint32_t)REPLAY_VERSION) &&
+              (header[6] <= IMPOSSIBLE) &&
+              (GetU16(header + 4) < 3 || header[7] < LEVEL_COUNT) &&
+              (GetU32(header + 16) <= 0x7FFFFFFF);
+
+    if (ok && GetU16(header + 4) >= 2) {
+        int extra = REPLAY_HEADER_SIZE - REPLAY_HEADER_SIZE_V1;
+        ok = (fread(header + REPLAY_HEADER_SIZE_V1, 1, extra, file) == (size_t)extra) &&
+             (GetU16(header + 20) <= (uint32_t)SIM_MAX_BALLS);
+    }
+
+    if (ok) {
+        replay->difficulty = (DifficultyLevel)header[6];
+        replay->seed = GetU64(header + 8);
+        replay->extraBalls = (int)GetU16(header + 20);
+        replay->level = (GetU16(header + 4) >= 3) ? (int)header[7] : (int)LEVEL_CLASSIC;
+        replay->tickCount = (int)GetU32(header + 16);
+
+        // A truncated or corrupt file can claim any tick count, check it before allocating for it
+        size_t inputBytes = ((size_t)replay->tickCount + 1) / 2;
+        ok = (inputBytes <= (size_t)RemainingBytes(file));
+        replay->inputs.resize(ok ? inputBytes : 0);
+        if (ok && !replay->inputs.empty()) {
+            ok = (fread(replay->inputs.data(), 1, replay->inputs.size(), file) == replay->inputs.size());
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+//----------------------------------------------------------------------------------
+// Playback
+//----------------------------------------------------------------------------------
+// Simulation state before the first recorded tick
+static void InitReplaySim(const Replay *replay, PongSim *sim)
+{
+    InitPongSim(sim, replay->difficulty, replay->seed);
+    SetPongSimLevel(sim, replay->level);
+    SetPongSimExtraBalls(sim, replay->extraBalls);
+}
+
+void StartReplayPlayback(ReplayPlayback *playback, const Replay *replay, PongSim *sim)
+{
+    playback->replay = replay;
+    playback->tick = 0;
+    playback->snapshots.clear();
+    InitReplaySim(replay, sim);
+}
+
+bool NextReplayInput(ReplayPlayback *playback, const PongSim *sim, unsigned int *input)
+{
+    if (playback->tick >= playback->replay->tickCount) return false;
+
+    // Snapshots are taken lazily the first time playback passes each interval
+    if (playback->tick % REPLAY_SNAPSHOT_INTERVAL == 0 &&
+        (int)playback->snapshots.size() == playback->tick / REPLAY_SNAPSHOT_INTERVAL) {
+        playback->snapshots.push_back(*sim);
+    }
+
+    *input = GetReplayInput(playback->replay, playback->tick);
+    playback->tick++;
+    return true;
+}
+
+void SeekReplayPlayback(ReplayPlayback *playback, PongSim *sim, int tick)
+{
+    if (tick < 0) tick = 0;
+    if (tick > playback->replay->tickCount) tick = playback->replay->tickCount;
+
+    // Resume from the latest snapshot at or before the target, a forward seek within
+    // the current interval just keeps simulating from where playback is
+    int index = tick / REPLAY_SNAPSHOT_INTERVAL;
+    if (index >= (int)playback->snapshots.size()) index = (int)playback->snapshots.size() - 1;
+    if (index >= 0 && (tick < playback->tick || index * REPLAY_SNAPSHOT_INTERVAL > playback->tick)) {
+        *sim = playback->snapshots[index];
+        playback->tick = index * REPLAY_SNAPSHOT_INTERVAL;
+    }
+    else if (index < 0 && tick < playback->tick) {
+        InitReplaySim(playback->replay, sim);
+        playback->tick = 0;
+    }
+
+    unsigned int input;
+    while (playback->tick < tick && NextReplayInput(playback, sim, &input)) {
+        StepPongSim(sim, input);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+//----------------------------------------------------------------------------------
+// Match replays: the seed, the difficulty, the match setup and one input nibble per tick
+// The simulation is deterministic, so feeding the inputs back through StepPongSim()
+// reproduces the match exactly
+//
+// File layout, little-endian:
+//   char[4]  magic "PPRP"
+//   uint16   version
+//   uint8    difficulty
+//   uint8    level (version 3, reserved before)
+//   uint64   seed
+//   uint32   tick count
+//   uint16   extra balls (version 2)
+//   uint16   reserved (version 2)
+//   uint8[]  inputs, two ticks per byte, low nibble first
+// Version 1 files have no extra ball fields and load as single-ball matches, files before
+// version 3 play on the classic court
+//----------------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+
+#include "pong_sim.h"
+
+static const int REPLAY_VERSION = 3;
+static const int REPLAY_SNAPSHOT_INTERVAL = 5 * SIM_TICK_RATE;    // Ticks between seek snapshots
+
+struct Replay {
+    uint64_t seed;
+    DifficultyLevel difficulty;
+    int extraBalls;                     // Multi-ball mode, set before the first tick is recorded
+    int level;                          // LevelId, likewise
+    int tickCount;
+    std::vector<unsigned char> inputs;   // Packed input nibbles
+};
+
+// Playback cursor, the caller owns the PongSim and steps it with each returned input
+struct ReplayPlayback {
+    const Replay *replay;
+    int tick;                           // Next tick to feed
+    std::vector<PongSim> snapshots;     // Simulation state before every REPLAY_SNAPSHOT_INTERVAL-th tick
+};
+
+void BeginReplayRecording(Replay *replay, uint64_t seed, DifficultyLevel difficulty);  // Clear and start a new recording, single-ball, classic court
+void RecordReplayTick(Replay *replay, unsigned int input);                            // Append one tick of input
+unsigned int GetReplayInput(const Replay *replay, int tick);                          // Input for a recorded tick
+bool SaveReplay(const Replay *replay, const char *fileName);
+bool LoadReplay(Replay *replay, const char *fileName);
+
+void StartReplayPlayback(ReplayPlayback *playback, const Replay *replay, PongSim *sim);   // Init sim from the replay header
+bool NextReplayInput(ReplayPlayback *playback, const PongSim *sim, unsigned int *input);  // False once every tick is fed
+void SeekReplayPlayback(ReplayPlayback *playback, PongSim *sim, int tick);                // Restore the nearest snapshot and re-simulate
+
+#endif // REPLAY_H
@@ -0,0 +1,51 @@
+#version 100
+
+precision mediump float;
+
+// Input vertex attributes (from vertex shader)
+varying vec2 fragTexCoord;
+varying vec4 fragColor;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+uniform vec2 resolution;        // Virtual canvas size, effects are sized in its pixels
+uniform vec2 shakeOffset;       // Screen shake in pixels
+uniform float scanlines;        // Darkening of every 4th row, 0 disables
+uniform float bloom;            // Glow around bright pixels, 0 disables
+
+// Whole-frame effects in one pass, the cost doesn't depend on how strong they are
+void main()
+{
+    vec2 texel = 1.0/resolution;
+    vec2 uv = fragTexCoord + shakeOffset*texel;
+
+    // Shaking reveals black past the scene edges
+    if (uv.x < 0.0 || uv.x > 1.0 || uv.y < 0.0 || uv.y > 1.0)
+    {
+        gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    vec3 color = texture2D(texture0, uv).rgb;
+
+    if (bloom > 0.0)
+    {
+        // Two rings of 8 taps, only the part above the threshold glows
+        vec3 glow = vec3(0.0);
+        for (int i = 0; i < 8; i++)
+        {
+            float angle = float(i)*0.7853982;
+            vec2 dir = vec2(cos(angle), sin(angle))*texel;
+            glow += max(texture2D(texture0, uv + dir*3.0).rgb - 0.5, 0.0);
+            glow += max(texture2D(texture0, uv + dir*6.0).rgb - 0.5, 0.0)*0.5;
+        }
+        color += glow*(bloom/8.0);
+    }
+
+    // Render textures are stored bottom-up, count rows from the top of the scene
+    float row = floor((1.0 - uv.y)*resolution.y);
+    if (mod(row, 4.0) < 0.5) color *= 1.0 - scanlines;
+
+    gl_FragColor = vec4(color, 1.0)*colDiffuse*fragColor;
+}
@@ -0,0 +1,21 @@
+#version 100
+
+precision mediump float;
+
+// Input vertex attributes (from vertex shader)
+varying vec2 fragTexCoord;
+varying vec4 fragColor;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+uniform float time;
+
+// Starfield twinkle: vertex alpha holds each star's phase as a fraction of a full turn
+void main()
+{
+    vec4 texelColor = texture2D(texture0, fragTexCoord);
+    float brightness = 0.7 + 0.3*sin(time*2.0 + fragColor.a*6.2831853);
+
+    gl_FragColor = texelColor*colDiffuse*vec4(fragColor.rgb, brightness);
+}
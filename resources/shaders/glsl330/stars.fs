@@ -0,0 +1,22 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+uniform float time;
+
+// Output fragment color
+out vec4 finalColor;
+
+// Starfield twinkle: vertex alpha holds each star's phase as a fraction of a full turn
+void main()
+{
+    vec4 texelColor = texture(texture0, fragTexCoord);
+    float brightness = 0.7 + 0.3*sin(time*2.0 + fragColor.a*6.2831853);
+
+    finalColor = texelColor*colDiffuse*vec4(fragColor.rgb, brightness);
+}
@@ -0,0 +1,137 @@
+#include "sim_thread.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+static const int SNAPSHOT_FRESH = 4;                // Flag in middleIndex, the renderer hasn't taken that snapshot yet
+static const double SIM_THREAD_MAX_LAG = 0.25;      // Ticks further behind than this are dropped, not caught up
+
+// Triple buffer. backIndex belongs to the thread, frontIndex to the renderer, middleIndex is the
+// only thing they share and it only ever changes hands with an atomic exchange
+static SimSnapshot buffers[3];
+static std::atomic<int> middleIndex(1);
+static int backIndex = 0;
+static int frontIndex = 2;
+static unsigned int deliveredSerial = 0;            // Last event handed to the renderer
+
+// Owned by the thread while it runs
+static PongSim threadSim;
+static Replay *threadRecording = NULL;
+static SimEvent recentEvents[SIM_THREAD_MAX_EVENTS];    // Ring indexed by serial
+static unsigned int eventSerial = 0;
+
+static std::thread simThread;
+static std::atomic<bool> stopRequested(false);
+static std::atomic<unsigned int> heldInput(0);
+static bool running = false;
+
+//----------------------------------------------------------------------------------
+// Module Internal Functions
+//----------------------------------------------------------------------------------
+static void RunTick(void)
+{
+    SimSnapshot *snapshot = &buffers[backIndex];
+    snapshot->prevBallX = threadSim.ball.x;
+    snapshot->prevBallY = threadSim.ball.y;
+    snapshot->prevPlayerPaddleY = threadSim.playerPaddle.y;
+    snapshot->prevComputerPaddleY = threadSim.computerPaddle.y;
+    int extraBalls = threadSim.extraBalls.count;
+    memcpy(snapshot->prevExtraBallX, threadSim.extraBalls.x, extraBalls * sizeof(float));
+    memcpy(snapshot->prevExtraBallY, threadSim.extraBalls.y, extraBalls * sizeof(float));
+
+    unsigned int input = heldInput.load(std::memory_order_relaxed);
+    StepPongSim(&threadSim, input);
+    if (threadRecording != NULL) RecordReplayTick(threadRecording, input);
+    for (int i = 0; i < threadSim.eventCount; i++) recentEvents[eventSerial++ % SIM_THREAD_MAX_EVENTS] = threadSim.events[i];
+
+    snapshot->sim = threadSim;
+    snapshot->tickTime = GetSimThreadTime();
+    int count = (eventSerial < (unsigned int)SIM_THREAD_MAX_EVENTS) ? (int)eventSerial : SIM_THREAD_MAX_EVENTS;
+    for (int i = 0; i < count; i++) snapshot->events[i] = recentEvents[(eventSerial - count + i) % SIM_THREAD_MAX_EVENTS];
+    snapshot->eventCount = count;
+    snapshot->lastEventSerial = eventSerial;
+
+    // acq_rel: the renderer sees the whole snapshot along with its index, and the buffer handed back is one it let go of
+    backIndex = middleIndex.exchange(backIndex | SNAPSHOT_FRESH, std::memory_order_acq_rel) & 3;
+}
+
+static void SimThreadMain(void)
+{
+    double nextTick = GetSimThreadTime() + SIM_DT;
+    while (!stopRequested.load(std::memory_order_acquire)) {
+        double now = GetSimThreadTime();
+        if (now < nextTick) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(nextTick - now));
+            continue;
+        }
+
+        // After a long stall carry on from now, a burst of catch-up ticks would look like a skip anyway
+        if (now - nextTick > SIM_THREAD_MAX_LAG) nextTick = now;
+        nextTick += SIM_DT;
+        RunTick();
+
+        // The renderer ends the match from the last snapshot
+        if (threadSim.matchOver) break;
+    }
+}
+
+//----------------------------------------------------------------------------------
+// Module functions
+//----------------------------------------------------------------------------------
+void StartSimThread(const PongSim *sim, Replay *recording)
+{
+    if (running) StopSimThread();
+
+    threadSim = *sim;
+    threadRecording = recording;
+    eventSerial = 0;
+    deliveredSerial = 0;
+    backIndex = 0;
+    frontIndex = 2;
+    middleIndex.store(1, std::memory_order_relaxed);
+    stopRequested.store(false, std::memory_order_relaxed);
+
+    simThread = std::thread(SimThreadMain);
+    running = true;
+}
+
+void StopSimThread(void)
+{
+    if (!running) return;
+    stopRequested.store(true, std::memory_order_release);
+    simThread.join();
+    running = false;
+}
+
+bool IsSimThreadRunning(void)
+{
+    return running;
+}
+
+void SetSimThreadInput(unsigned int input)
+{
+    heldInput.store(input, std::memory_order_relaxed);
+}
+
+const SimSnapshot *AcquireSimSnapshot(void)
+{
+    if ((middleIndex.load(std::memory_order_relaxed) & SNAPSHOT_FRESH) == 0) return NULL;
+    frontIndex = middleIndex.exchange(frontIndex, std::memory_order_acq_rel) & 3;
+
+    // The front buffer is the renderer's until the next call, trim it to the events not yet delivered
+    SimSnapshot *snapshot = &buffers[frontIndex];
+    int fresh = (int)(snapshot->lastEventSerial - deliveredSerial);
+    if (fresh < snapshot->eventCount) {
+        memmove(snapshot->events, snapshot->events + (snapshot->eventCount - fresh), fresh * sizeof(SimEvent));
+        snapshot->eventCount = fresh;
+    }
+    deliveredSerial = snapshot->lastEventSerial;
+    return snapshot;
+}
+
+double GetSimThreadTime(void)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,41 @@
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+//----------------------------------------------------------------------------------
+// Fixed-rate simulation on its own thread, for desktop builds (--threaded)
+//
+// While it runs, the thread owns a copy of the PongSim and steps it every SIM_DT on its
+// own clock, so a slow frame never delays a tick and a slow tick never holds up a frame.
+// After each tick it publishes an immutable snapshot through a lock-free triple buffer:
+// the thread fills the back buffer and swaps it with the middle one, the renderer swaps
+// the middle one with its front buffer whenever a newer snapshot is waiting. Neither
+// side ever blocks on the other
+//
+// Every snapshot carries the most recent events, numbered, and the renderer only gets
+// the ones it hasn't seen, so snapshots it skips lose no sounds or particle bursts
+//----------------------------------------------------------------------------------
+#include "pong_sim.h"
+#include "replay.h"
+
+static const int SIM_THREAD_MAX_EVENTS = 64;        // Recent events kept in every snapshot, several frames' worth
+
+struct SimSnapshot {
+    PongSim sim;                                    // State after the tick
+    float prevBallX, prevBallY;                     // Positions before it, for interpolation
+    float prevPlayerPaddleY, prevComputerPaddleY;
+    float prevExtraBallX[SIM_MAX_BALLS];
+    float prevExtraBallY[SIM_MAX_BALLS];
+    double tickTime;                                // GetSimThreadTime() when the tick ran
+    SimEvent events[SIM_THREAD_MAX_EVENTS];         // Oldest first, after AcquireSimSnapshot() only the new ones
+    int eventCount;
+    unsigned int lastEventSerial;                   // Events so far, numbering the last one in events
+};
+
+void StartSimThread(const PongSim *sim, Replay *recording);     // Ticks a copy of sim, appending each input to recording
+void StopSimThread(void);                                       // Waits for the thread to finish, the last snapshot stays available
+bool IsSimThreadRunning(void);
+void SetSimThreadInput(unsigned int input);                     // Held keys for the ticks that follow
+const SimSnapshot *AcquireSimSnapshot(void);                    // Newest snapshot, NULL when nothing new since the last call
+double GetSimThreadTime(void);                                  // Seconds on the clock tick times are taken from
+
+#endif // SIM_THREAD_H
@@ -0,0 +1,93 @@
+#ifndef SIMD4_H
+#define SIMD4_H
+
+//----------------------------------------------------------------------------------
+// Minimal 4-wide float vectors: SSE2 on x86, SIMD128 on wasm (build with -msimd128),
+// plain arrays elsewhere. Masks are all-ones / all-zero lanes, as the hardware returns them
+// Only IEEE add, sub, mul, min, max and compares are used, so every path gives the same
+// bits as scalar code doing the same operations in the same order
+//----------------------------------------------------------------------------------
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #include <emmintrin.h>
+    #define SIMD4_SSE2
+#elif defined(__wasm_simd128__)
+    #include <wasm_simd128.h>
+    #define SIMD4_WASM
+#else
+    #include <cstdint>
+    #include <cstring>
+    #define SIMD4_SCALAR
+#endif
+
+#if defined(SIMD4_SSE2)
+
+typedef __m128 Float4;
+
+static inline Float4 Load4(const float *p) { return _mm_loadu_ps(p); }
+static inline void Store4(float *p, Float4 v) { _mm_storeu_ps(p, v); }
+static inline Float4 Splat4(float f) { return _mm_set1_ps(f); }
+static inline Float4 Add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+static inline Float4 Sub4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+static inline Float4 Mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+static inline Float4 Min4(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+static inline Float4 Max4(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+static inline Float4 Less4(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+static inline Float4 Greater4(Float4 a, Float4 b) { return _mm_cmpgt_ps(a, b); }
+static inline Float4 And4(Float4 a, Float4 b) { return _mm_and_ps(a, b); }
+static inline Float4 Or4(Float4 a, Float4 b) { return _mm_or_ps(a, b); }
+static inline Float4 Select4(Float4 mask, Float4 a, Float4 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+static inline Float4 Abs4(Float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+static inline Float4 Neg4(Float4 a) { return _mm_xor_ps(_mm_set1_ps(-0.0f), a); }
+static inline int MaskBits4(Float4 mask) { return _mm_movemask_ps(mask); }
+
+#elif defined(SIMD4_WASM)
+
+typedef v128_t Float4;
+
+static inline Float4 Load4(const float *p) { return wasm_v128_load(p); }
+static inline void Store4(float *p, Float4 v) { wasm_v128_store(p, v); }
+static inline Float4 Splat4(float f) { return wasm_f32x4_splat(f); }
+static inline Float4 Add4(Float4 a, Float4 b) { return wasm_f32x4_add(a, b); }
+static inline Float4 Sub4(Float4 a, Float4 b) { return wasm_f32x4_sub(a, b); }
+static inline Float4 Mul4(Float4 a, Float4 b) { return wasm_f32x4_mul(a, b); }
+static inline Float4 Min4(Float4 a, Float4 b) { return wasm_f32x4_pmin(b, a); }     // Same lane pick as _mm_min_ps
+static inline Float4 Max4(Float4 a, Float4 b) { return wasm_f32x4_pmax(b, a); }
+static inline Float4 Less4(Float4 a, Float4 b) { return wasm_f32x4_lt(a, b); }
+static inline Float4 Greater4(Float4 a, Float4 b) { return wasm_f32x4_gt(a, b); }
+static inline Float4 And4(Float4 a, Float4 b) { return wasm_v128_and(a, b); }
+static inline Float4 Or4(Float4 a, Float4 b) { return wasm_v128_or(a, b); }
+static inline Float4 Select4(Float4 mask, Float4 a, Float4 b) { return wasm_v128_bitselect(a, b, mask); }
+static inline Float4 Abs4(Float4 a) { return wasm_f32x4_abs(a); }
+static inline Float4 Neg4(Float4 a) { return wasm_f32x4_neg(a); }
+static inline int MaskBits4(Float4 mask) { return wasm_i32x4_bitmask(mask); }
+
+#else
+
+struct Float4 { float v[4]; };
+
+static inline Float4 Load4(const float *p) { Float4 r; memcpy(r.v, p, sizeof(r.v)); return r; }
+static inline void Store4(float *p, Float4 v) { memcpy(p, v.v, sizeof(v.v)); }
+static inline Float4 Splat4(float f) { Float4 r = {{ f, f, f, f }}; return r; }
+static inline float MaskLane4(bool set) { uint32_t bits = set ? 0xFFFFFFFFu : 0u; float f; memcpy(&f, &bits, 4); return f; }
+static inline uint32_t LaneBits4(float f) { uint32_t bits; memcpy(&bits, &f, 4); return bits; }
+static inline float BitsLane4(uint32_t bits) { float f; memcpy(&f, &bits, 4); return f; }
+
+#define SIMD4_LANEWISE(expr) Float4 r; for (int i = 0; i < 4; i++) r.v[i] = (expr); return r;
+static inline Float4 Add4(Float4 a, Float4 b) { SIMD4_LANEWISE(a.v[i] + b.v[i]) }
+static inline Float4 Sub4(Float4 a, Float4 b) { SIMD4_LANEWISE(a.v[i] - b.v[i]) }
+static inline Float4 Mul4(Float4 a, Float4 b) { SIMD4_LANEWISE(a.v[i] * b.v[i]) }
+static inline Float4 Min4(Float4 a, Float4 b) { SIMD4_LANEWISE((a.v[i] < b.v[i]) ? a.v[i] : b.v[i]) }
+static inline Float4 Max4(Float4 a, Float4 b) { SIMD4_LANEWISE((a.v[i] > b.v[i]) ? a.v[i] : b.v[i]) }
+static inline Float4 Less4(Float4 a, Float4 b) { SIMD4_LANEWISE(MaskLane4(a.v[i] < b.v[i])) }
+static inline Float4 Greater4(Float4 a, Float4 b) { SIMD4_LANEWISE(MaskLane4(a.v[i] > b.v[i])) }
+static inline Float4 And4(Float4 a, Float4 b) { SIMD4_LANEWISE(BitsLane4(LaneBits4(a.v[i]) & LaneBits4(b.v[i]))) }
+static inline Float4 Or4(Float4 a, Float4 b) { SIMD4_LANEWISE(BitsLane4(LaneBits4(a.v[i]) | LaneBits4(b.v[i]))) }
+static inline Float4 Select4(Float4 mask, Float4 a, Float4 b) { SIMD4_LANEWISE(LaneBits4(mask.v[i]) ? a.v[i] : b.v[i]) }
+static inline Float4 Abs4(Float4 a) { SIMD4_LANEWISE(BitsLane4(LaneBits4(a.v[i]) & 0x7FFFFFFFu)) }
+static inline Float4 Neg4(Float4 a) { SIMD4_LANEWISE(BitsLane4(LaneBits4(a.v[i]) ^ 0x80000000u)) }
+#undef SIMD4_LANEWISE
+static inline int MaskBits4(Float4 mask) { int bits = 0; for (int i = 0; i < 4; i++) if (LaneBits4(mask.v[i])) bits |= 1 << i; return bits; }
+
+#endif
+
+#endif // SIMD4_H
@@ -0,0 +1,53 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+//----------------------------------------------------------------------------------
+// Bounded lock-free queue for exactly one producer thread and one consumer thread
+// Push and pop never block or allocate, a full queue rejects the push instead
+// N must be a power of two, one slot is never used to tell full from empty
+//----------------------------------------------------------------------------------
+#include <atomic>
+
+template <typename T, int N>
+struct SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+    T items[N];
+    alignas(64) std::atomic<unsigned int> head;     // Next slot to read, only the consumer writes it
+    alignas(64) std::atomic<unsigned int> tail;     // Next slot to write, only the producer writes it
+};
+
+// Not thread safe, call before either side starts using the queue
+template <typename T, int N>
+void ResetSpscQueue(SpscQueue<T, N> *queue)
+{
+    queue->head.store(0, std::memory_order_relaxed);
+    queue->tail.store(0, std::memory_order_relaxed);
+}
+
+// Producer side, false when the queue is full
+template <typename T, int N>
+bool PushSpscQueue(SpscQueue<T, N> *queue, const T &item)
+{
+    unsigned int tail = queue->tail.load(std::memory_order_relaxed);
+    unsigned int next = (tail + 1) & (N - 1);
+    if (next == queue->head.load(std::memory_order_acquire)) return false;
+
+    queue->items[tail] = item;
+    queue->tail.store(next, std::memory_order_release);     // Publishes the item to the consumer
+    return true;
+}
+
+// Consumer side, false when the queue is empty
+template <typename T, int N>
+bool PopSpscQueue(SpscQueue<T, N> *queue, T *item)
+{
+    unsigned int head = queue->head.load(std::memory_order_relaxed);
+    if (head == queue->tail.load(std::memory_order_acquire)) return false;
+
+    *item = queue->items[head];
+    queue->head.store((head + 1) & (N - 1), std::memory_order_release);  // Hands the slot back to the producer
+    return true;
+}
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,193 @@
+#include "telemetry.h"
+#include "spsc_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+static const int TELEMETRY_WRITE_BATCH = 512;           // Events encoded per fwrite
+static const int TELEMETRY_WRITE_INTERVAL_MS = 50;      // Writer sleep between drains
+
+static SpscQueue<TelemetryEvent, TELEMETRY_RING> ring;     // The game pushes, the writer pops
+static long long droppedEvents = 0;                         // Pushing thread only
+
+static std::thread writerThread;
+static std::atomic<bool> stopRequested(false);
+static bool running = false;
+
+// Writer thread only
+static std::string logPath;
+static FILE *logFile = NULL;
+static long logBytes = 0;
+static long long writtenEvents = 0;
+static int logFiles = 0;
+
+//----------------------------------------------------------------------------------
+// Module Internal Functions
+//----------------------------------------------------------------------------------
+static void PutU16(unsigned char *p, uint16_t v) { p[0] = v & 0xFF; p[1] = v >> 8; }
+static void PutU32(unsigned char *p, uint32_t v) { PutU16(p, v & 0xFFFF); PutU16(p + 2, v >> 16); }
+static uint16_t GetU16(const unsigned char *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t GetU32(const unsigned char *p) { return GetU16(p) | ((uint32_t)GetU16(p + 2) << 16); }
+
+static void PutFloat(unsigned char *p, float v)
+{
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    PutU32(p, bits);
+}
+
+static float GetFloat(const unsigned char *p)
+{
+    uint32_t bits = GetU32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static std::string RotatedPath(int index)
+{
+    return logPath + "." + std::to_string(index);
+}
+
+static bool OpenLogFile(void)
+{
+    logFile = fopen(logPath.c_str(), "wb");
+    if (logFile == NULL) return false;
+
+    unsigned char header[TELEMETRY_HEADER_SIZE];
+    memcpy(header, "PTLM", 4);
+    PutU16(header + 4, TELEMETRY_VERSION);
+    PutU16(header + 6, TELEMETRY_EVENT_SIZE);
+    fwrite(header, 1, sizeof(header), logFile);
+    logBytes = sizeof(header);
+    logFiles++;
+    return true;
+}
+
+// PATH.(KEEP-1) -> PATH.KEEP, ..., PATH -> PATH.1, then start a fresh PATH
+static void RotateLogFile(void)
+{
+    fclose(logFile);
+    logFile = NULL;
+    remove(RotatedPath(TELEMETRY_KEEP_FILES).c_str());
+    for (int i = TELEMETRY_KEEP_FILES - 1; i >= 1; i--) rename(RotatedPath(i).c_str(), RotatedPath(i + 1).c_str());
+    rename(logPath.c_str(), RotatedPath(1).c_str());
+    OpenLogFile();
+}
+
+static void WriteEvents(void)
+{
+    static TelemetryEvent events[TELEMETRY_WRITE_BATCH];
+    static unsigned char data[TELEMETRY_WRITE_BATCH * TELEMETRY_EVENT_SIZE];
+
+    int count;
+    while ((count = DrainTelemetry(events, TELEMETRY_WRITE_BATCH)) > 0) {
+        if (logFile == NULL) continue;      // Rotation failed to reopen, keep draining so the game never stalls
+        for (int i = 0; i < count; i++) EncodeTelemetryEvent(&events[i], data + i * TELEMETRY_EVENT_SIZE);
+        fwrite(data, TELEMETRY_EVENT_SIZE, count, logFile);
+        logBytes += count * TELEMETRY_EVENT_SIZE;
+        writtenEvents += count;
+        if (logBytes >= TELEMETRY_MAX_FILE_BYTES) RotateLogFile();
+    }
+    if (logFile != NULL) fflush(logFile);
+}
+
+static void WriterMain(void)
+{
+    for (;;) {
+        // Read the flag before draining, so everything pushed before StopTelemetry() gets written
+        bool stopping = stopRequested.load(std::memory_order_acquire);
+        WriteEvents();
+        if (stopping) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(TELEMETRY_WRITE_INTERVAL_MS));
+    }
+}
+
+//----------------------------------------------------------------------------------
+// Module functions
+//----------------------------------------------------------------------------------
+bool StartTelemetry(const char *path)
+{
+    if (running) StopTelemetry();
+
+    logPath = path;
+    logFiles = 0;
+    writtenEvents = 0;
+    droppedEvents = 0;
+    ResetSpscQueue(&ring);
+    if (!OpenLogFile()) return false;
+
+    stopRequested.store(false, std::memory_order_relaxed);
+    writerThread = std::thread(WriterMain);
+    running = true;
+    return true;
+}
+
+TelemetryStats StopTelemetry(void)
+{
+    TelemetryStats stats = { 0, 0, 0 };
+    if (!running) return stats;
+
+    stopRequested.store(true, std::memory_order_release);
+    writerThread.join();
+    running = false;
+    if (logFile != NULL) fclose(logFile);
+    logFile = NULL;
+
+    stats.written = writtenEvents;
+    stats.dropped = droppedEvents;
+    stats.files = logFiles;
+    return stats;
+}
+
+bool PushTelemetry(const TelemetryEvent *event)
+{
+    if (PushSpscQueue(&ring, *event)) return true;
+    droppedEvents++;
+    return false;
+}
+
+int DrainTelemetry(TelemetryEvent *events, int maxCount)
+{
+    int count = 0;
+    while (count < maxCount && PopSpscQueue(&ring, &events[count])) count++;
+    return count;
+}
+
+void EncodeTelemetryEvent(const TelemetryEvent *event, unsigned char *data)
+{
+    data[0] = event->type;
+    data[1] = event->side;
+    data[2] = event->difficulty;
+    data[3] = event->flags;
+    PutU32(data + 4, event->tick);
+    PutFloat(data + 8, event->x);
+    PutFloat(data + 12, event->y);
+    PutFloat(data + 16, event->speedX);
+    PutFloat(data + 20, event->speedY);
+    PutFloat(data + 24, event->hitPosition);
+}
+
+void DecodeTelemetryEvent(const unsigned char *data, TelemetryEvent *event)
+{
+    event->type = data[0];
+    event->side = data[1];
+    event->difficulty = data[2];
+    event->flags = data[3];
+    event->tick = GetU32(data + 4);
+    event->x = GetFloat(data + 8);
+    event->y = GetFloat(data + 12);
+    event->speedX = GetFloat(data + 16);
+    event->speedY = GetFloat(data + 20);
+    event->hitPosition = GetFloat(data + 24);
+}
+
+bool ReadTelemetryHeader(const unsigned char *data, int size)
+{
+    return size >= TELEMETRY_HEADER_SIZE && memcmp(data, "PTLM", 4) == 0 &&
+           GetU16(data + 4) == TELEMETRY_VERSION && GetU16(data + 6) == TELEMETRY_EVENT_SIZE;
+}
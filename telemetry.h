@@ -0,0 +1,76 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+//----------------------------------------------------------------------------------
+// Gameplay telemetry: fixed-size events pushed into a single-producer ring buffer and
+// written out by a background thread, for tools/pong_telemetry to aggregate
+//
+// PushTelemetry() is the only call on the frame. It copies one event into an SpscQueue
+// and publishes it with an atomic store, no allocation, no lock, no system call. When the
+// writer falls behind the ring fills up and new events are dropped, and counted, rather
+// than ever blocking the game. One thread pushes, the writer thread drains
+//
+// Log files rotate: once the log passes TELEMETRY_MAX_FILE_BYTES it becomes PATH.1, the
+// older PATH.1 becomes PATH.2 and so on, and the oldest beyond TELEMETRY_KEEP_FILES is
+// deleted
+//
+// File layout, little-endian:
+//   char[4]  magic "PTLM"
+//   uint16   version
+//   uint16   event size, 28
+//   events:  uint8 type, uint8 side, uint8 difficulty, uint8 flags, uint32 tick,
+//            float x, float y, float speed x, float speed y, float hit position
+// MATCH_START and MATCH_END put the player and computer scores in x and y
+//----------------------------------------------------------------------------------
+#include <cstdint>
+
+static const int TELEMETRY_VERSION = 1;
+static const int TELEMETRY_EVENT_SIZE = 28;             // Bytes per event in the file
+static const int TELEMETRY_HEADER_SIZE = 8;
+static const int TELEMETRY_RING = 8192;                 // Queue slots, power of two
+static const long TELEMETRY_MAX_FILE_BYTES = 4L << 20;
+static const int TELEMETRY_KEEP_FILES = 4;              // Rotated files kept besides the live one
+
+enum TelemetryEventType {
+    TELEMETRY_MATCH_START,
+    TELEMETRY_PADDLE_HIT,
+    TELEMETRY_WALL_HIT,
+    TELEMETRY_SCORE,
+    TELEMETRY_MATCH_END,                // Played to the end, or abandoned with TELEMETRY_ABANDONED
+    TELEMETRY_OBSTACLE_HIT,             // A level obstacle, side is the half of the court it is in
+    TELEMETRY_EVENT_TYPES
+};
+
+enum TelemetryFlags {
+    TELEMETRY_SPEED_CLAMPED = 1,        // PADDLE_HIT: the return was held to the top speed
+    TELEMETRY_ABANDONED = 2,            // MATCH_END: left before anyone won
+    TELEMETRY_ONLINE = 4                // The match was played over the network
+};
+
+struct TelemetryEvent {
+    uint8_t type;                       // TelemetryEventType
+    uint8_t side;                       // CourtSide that hit or scored, MATCH_END the winner
+    uint8_t difficulty;                 // DifficultyLevel
+    uint8_t flags;                      // TelemetryFlags
+    uint32_t tick;
+    float x, y;
+    float speedX, speedY;
+    float hitPosition;                  // PADDLE_HIT: -1 top end of the paddle to 1 bottom end
+};
+
+struct TelemetryStats {
+    long long written;
+    long long dropped;                  // Pushed while the ring was full
+    int files;                          // Rotations, plus the first file
+};
+
+bool StartTelemetry(const char *path);              // Opens the log and starts the writer thread
+TelemetryStats StopTelemetry(void);                 // Writes out everything pushed so far, then closes the log
+bool PushTelemetry(const TelemetryEvent *event);    // False when the ring was full and the event was dropped
+int DrainTelemetry(TelemetryEvent *events, int maxCount);   // The writer's side of the ring, for in-process consumers
+
+void EncodeTelemetryEvent(const TelemetryEvent *event, unsigned char *data);    // TELEMETRY_EVENT_SIZE bytes
+void DecodeTelemetryEvent(const unsigned char *data, TelemetryEvent *event);
+bool ReadTelemetryHeader(const unsigned char *data, int size);                  // Magic, version and event size match
+
+#endif // TELEMETRY_H
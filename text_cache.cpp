@@ -0,0 +1,193 @@
+#include "text_cache.h"
+
+#include <rlgl.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+//----------------------------------------------------------------------------------
+// Atlas and lookup table
+//----------------------------------------------------------------------------------
+static const int TEXT_ATLAS_SIZE = 1024;
+static const int TEXT_CACHE_CAPACITY = 512;         // Power of two, open addressing
+static const int TEXT_CACHE_MAX_ENTRIES = TEXT_CACHE_CAPACITY * 3 / 4;
+static const int TEXT_CACHE_MAX_LENGTH = 96;        // Longer strings bypass the cache
+
+struct TextCacheEntry {
+    bool used;
+    uint64_t hash;
+    int fontSize;
+    char text[TEXT_CACHE_MAX_LENGTH];
+    Rectangle source;           // Region in the atlas
+    int width;                  // MeasureText() result
+};
+
+static TextCacheEntry entries[TEXT_CACHE_CAPACITY];
+static int entryCount = 0;
+static bool textCacheReady = false;
+
+static Texture2D atlas;
+static Image fontImage;         // CPU copy of the default font texture, RGBA
+
+// Shelf packer: rows filled left to right, a new row opens when one is full
+static int shelfX = 0, shelfY = 0, shelfHeight = 0;
+
+static uint64_t HashText(const char *text, int fontSize)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char *c = text; *c != '\0'; c++) hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+    return (hash ^ (uint64_t)fontSize) * 1099511628211ULL;
+}
+
+// Drop every entry, the atlas space is reused as text is drawn again
+static void ResetTextCache(void)
+{
+    // Quads already queued this frame still point at the old atlas contents
+    rlDrawRenderBatchActive();
+    memset(entries, 0, sizeof(entries));
+    entryCount = 0;
+    shelfX = shelfY = shelfHeight = 0;
+}
+
+static bool AllocateAtlasRegion(int width, int height, Rectangle *region)
+{
+    if (shelfX + width > TEXT_ATLAS_SIZE) {
+        shelfY += shelfHeight + 1;
+        shelfX = 0;
+        shelfHeight = 0;
+    }
+    if (shelfY + height > TEXT_ATLAS_SIZE) return false;
+
+    *region = (Rectangle){ (float)shelfX, (float)shelfY, (float)width, (float)height };
+    shelfX += width + 1;
+    if (height > shelfHeight) shelfHeight = height;
+    return true;
+}
+
+// Same glyph layout as DrawText(), each glyph quad covers the pixels whose centers fall
+// inside it and samples the nearest texel, matching the GPU with the font's point filtering
+static void RasterizeText(Color *pixels, int width, int height, const char *text, int fontSize)
+{
+    Font font = GetFontDefault();
+    float scale = (float)fontSize / font.baseSize;
+    float spacing = (float)(fontSize / font.baseSize);
+    const Color *fontPixels = (const Color *)fontImage.data;
+
+    float offsetX = 0.0f;
+    for (int i = 0; text[i] != '\0';) {
+        int codepointSize = 0;
+        int codepoint = GetCodepoint(&text[i], &codepointSize);
+        int index = GetGlyphIndex(font, codepoint);
+        if (codepoint == 0x3f) codepointSize = 1;   // Invalid UTF-8 falls back to '?', one byte
+        i += codepointSize;
+
+        Rectangle rec = font.recs[index];
+        if (codepoint != ' ' && codepoint != '\t') {
+            float padding = (float)font.glyphPadding;
+            float srcX = rec.x - padding, srcY = rec.y - padding;
+            float dstX = offsetX + (font.glyphs[index].offsetX - padding) * scale;
+            float dstY = (font.glyphs[index].offsetY - padding) * scale;
+            float dstWidth = (rec.width + 2 * padding) * scale;
+            float dstHeight = (rec.height + 2 * padding) * scale;
+
+            int x0 = (int)ceilf(dstX - 0.5f), x1 = (int)ceilf(dstX + dstWidth - 0.5f);
+            int y0 = (int)ceilf(dstY - 0.5f), y1 = (int)ceilf(dstY + dstHeight - 0.5f);
+            for (int y = (y0 < 0) ? 0 : y0; y < y1 && y < height; y++) {
+                int sy = (int)(srcY + (y + 0.5f - dstY) / scale);
+                for (int x = (x0 < 0) ? 0 : x0; x < x1 && x < width; x++) {
+                    int sx = (int)(srcX + (x + 0.5f - dstX) / scale);
+                    if (sx >= fontImage.width || sy >= fontImage.height) continue;
+                    unsigned char alpha = fontPixels[sy * fontImage.width + sx].a;
+                    if (alpha > pixels[y * width + x].a) pixels[y * width + x] = (Color){ 255, 255, 255, alpha };
+                }
+            }
+        }
+
+        if (font.glyphs[index].advanceX == 0) offsetX += rec.width * scale + spacing;
+        else offsetX += font.glyphs[index].advanceX * scale + spacing;
+    }
+}
+
+// Find a cached entry, rasterizing it on first use, NULL if the text can't be cached
+static const TextCacheEntry *GetTextEntry(const char *text, int fontSize)
+{
+    if (!textCacheReady || text[0] == '\0') return NULL;
+    if (fontSize < GetFontDefault().baseSize) fontSize = GetFontDefault().baseSize;   // Same clamp as DrawText()
+    size_t length = strlen(text);
+    if (length >= TEXT_CACHE_MAX_LENGTH) return NULL;
+
+    uint64_t hash = HashText(text, fontSize);
+    int slot = (int)(hash & (TEXT_CACHE_CAPACITY - 1));
+    while (entries[slot].used) {
+        if (entries[slot].hash == hash && entries[slot].fontSize == fontSize && strcmp(entries[slot].text, text) == 0) {
+            return &entries[slot];
+        }
+        slot = (slot + 1) & (TEXT_CACHE_CAPACITY - 1);
+    }
+
+    // Not cached yet, make room and rasterize it
+    int width = MeasureText(text, fontSize) + 1;
+    int height = fontSize;
+    if (width > TEXT_ATLAS_SIZE || height > TEXT_ATLAS_SIZE) return NULL;
+
+    Rectangle region;
+    if (entryCount >= TEXT_CACHE_MAX_ENTRIES || !AllocateAtlasRegion(width, height, &region)) {
+        ResetTextCache();
+        AllocateAtlasRegion(width, height, &region);
+        slot = (int)(hash & (TEXT_CACHE_CAPACITY - 1));
+    }
+
+    Color *pixels = (Color *)MemAlloc(width * height * sizeof(Color));
+    RasterizeText(pixels, width, height, text, fontSize);
+    UpdateTextureRec(atlas, region, pixels);
+    MemFree(pixels);
+
+    TextCacheEntry *entry = &entries[slot];
+    entry->used = true;
+    entry->hash = hash;
+    entry->fontSize = fontSize;
+    memcpy(entry->text, text, length + 1);
+    entry->source = region;
+    entry->width = width - 1;
+    entryCount++;
+    return entry;
+}
+
+//----------------------------------------------------------------------------------
+// Module functions
+//----------------------------------------------------------------------------------
+void InitTextCache(void)
+{
+    Image blank = GenImageColor(TEXT_ATLAS_SIZE, TEXT_ATLAS_SIZE, BLANK);
+    atlas = LoadTextureFromImage(blank);
+    UnloadImage(blank);
+
+    fontImage = LoadImageFromTexture(GetFontDefault().texture);
+    ImageFormat(&fontImage, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    textCacheReady = (atlas.id > 0) && (fontImage.data != NULL);
+    ResetTextCache();
+}
+
+void UnloadTextCache(void)
+{
+    if (atlas.id > 0) UnloadTexture(atlas);
+    UnloadImage(fontImage);
+    textCacheReady = false;
+}
+
+void DrawTextCached(const char *text, int posX, int posY, int fontSize, Color color)
+{
+    const TextCacheEntry *entry = GetTextEntry(text, fontSize);
+    if (entry == NULL) {
+        DrawText(text, posX, posY, fontSize, color);
+        return;
+    }
+    DrawTextureRec(atlas, entry->source, (Vector2){ (float)posX, (float)posY }, color);
+}
+
+int MeasureTextCached(const char *text, int fontSize)
+{
+    const TextCacheEntry *entry = GetTextEntry(text, fontSize);
+    return (entry != NULL) ? entry->width : MeasureText(text, fontSize);
+}
@@ -0,0 +1,19 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+//----------------------------------------------------------------------------------
+// Text cache: each distinct (text, font size) pair is rasterized once with the
+// default font into a shared atlas texture and then drawn as a single quad
+// Labels are baked in white and tinted at draw time, so color animation is free
+// Changing text such as scores only costs a rasterization the first time a value appears
+//----------------------------------------------------------------------------------
+#include <raylib.h>
+
+void InitTextCache(void);       // Create the atlas, call after InitWindow()
+void UnloadTextCache(void);
+
+// Drop-in replacements for DrawText() and MeasureText()
+void DrawTextCached(const char *text, int posX, int posY, int fontSize, Color color);
+int MeasureTextCached(const char *text, int fontSize);
+
+#endif // TEXT_CACHE_H
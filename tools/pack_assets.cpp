@@ -0,0 +1,142 @@
+//----------------------------------------------------------------------------------
+// Asset packer: writes every file under the given directories into one indexed
+// archive that asset_pack.cpp maps at startup. Layout is documented in asset_pack.h
+//
+// Usage: pack_assets OUTPUT DIR [DIR...]
+//        make assets      (packs resources/ into resources.pak)
+//
+// Paths are stored as found, with '/' separators, so "resources/gamelost.mp3" in the
+// pack answers the same name the game would have opened as a loose file
+// Hidden files and directories are skipped
+//----------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "asset_pack.h"
+
+struct PackEntry {
+    std::string name;
+    std::vector<unsigned char> data;
+    uint32_t offset;
+};
+
+static void PutU32(unsigned char *p, uint32_t v)
+{
+    p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; p[2] = (v >> 16) & 0xFF; p[3] = (v >> 24) & 0xFF;
+}
+
+static bool ReadWholeFile(const std::string &path, std::vector<unsigned char> *data)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL) return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data->resize((size > 0) ? (size_t)size : 0);
+    bool ok = (size >= 0) && (data->empty() || fread(data->data(), 1, data->size(), file) == data->size());
+    fclose(file);
+    return ok;
+}
+
+static bool CollectFiles(const std::string &directory, std::vector<PackEntry> *entries)
+{
+    DIR *dir = opendir(directory.c_str());
+    if (dir == NULL) {
+        fprintf(stderr, "Could not open directory: %s\n", directory.c_str());
+        return false;
+    }
+
+    bool ok = true;
+    struct dirent *item;
+    while (ok && (item = readdir(dir)) != NULL) {
+        if (item->d_name[0] == '.') continue;
+        std::string path = directory + "/" + item->d_name;
+
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) continue;
+        if (S_ISDIR(info.st_mode)) {
+            ok = CollectFiles(path, entries);
+        } else if (S_ISREG(info.st_mode)) {
+            if (path.size() >= (size_t)ASSET_PACK_NAME_SIZE) {
+                fprintf(stderr, "Path too long for the pack index: %s\n", path.c_str());
+                ok = false;
+                break;
+            }
+            PackEntry entry;
+            entry.name = path;
+            entry.offset = 0;
+            if (!ReadWholeFile(path, &entry.data)) {
+                fprintf(stderr, "Could not read: %s\n", path.c_str());
+                ok = false;
+                break;
+            }
+            entries->push_back(entry);
+        }
+    }
+    closedir(dir);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s OUTPUT DIR [DIR...]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<PackEntry> entries;
+    for (int i = 2; i < argc; i++) {
+        std::string directory = argv[i];
+        while (directory.size() > 1 && directory.back() == '/') directory.pop_back();
+        if (!CollectFiles(directory, &entries)) return 1;
+    }
+
+    // Sorted by byte order, the same order strcmp() gives the runtime's binary search
+    std::sort(entries.begin(), entries.end(), [](const PackEntry &a, const PackEntry &b) { return a.name < b.name; });
+
+    // Data after the index, each blob 16-byte aligned and followed by a NUL
+    size_t offset = ASSET_PACK_HEADER_SIZE + entries.size() * ASSET_PACK_ENTRY_SIZE;
+    for (PackEntry &entry : entries) {
+        offset = (offset + 15) & ~(size_t)15;
+        if (offset + entry.data.size() + 1 > 0xFFFFFFFFu) {
+            fprintf(stderr, "Pack would exceed 4 GB\n");
+            return 1;
+        }
+        entry.offset = (uint32_t)offset;
+        offset += entry.data.size() + 1;
+    }
+
+    std::vector<unsigned char> pack(offset, 0);
+    memcpy(pack.data(), "PPAK", 4);
+    PutU32(pack.data() + 4, ASSET_PACK_VERSION);
+    PutU32(pack.data() + 8, (uint32_t)entries.size());
+
+    size_t total = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        unsigned char *index = pack.data() + ASSET_PACK_HEADER_SIZE + i * ASSET_PACK_ENTRY_SIZE;
+        memcpy(index, entries[i].name.c_str(), entries[i].name.size());
+        PutU32(index + ASSET_PACK_NAME_SIZE, entries[i].offset);
+        PutU32(index + ASSET_PACK_NAME_SIZE + 4, (uint32_t)entries[i].data.size());
+        if (!entries[i].data.empty()) memcpy(pack.data() + entries[i].offset, entries[i].data.data(), entries[i].data.size());
+        total += entries[i].data.size();
+        printf("%10zu  %s\n", entries[i].data.size(), entries[i].name.c_str());
+    }
+
+    FILE *file = fopen(argv[1], "wb");
+    bool ok = (file != NULL) && (fwrite(pack.data(), 1, pack.size(), file) == pack.size());
+    if (file != NULL && fclose(file) != 0) ok = false;
+    if (!ok) {
+        fprintf(stderr, "Could not write: %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("%zu files, %zu bytes of assets, %zu bytes packed to %s\n", entries.size(), total, pack.size(), argv[1]);
+    return 0;
+}
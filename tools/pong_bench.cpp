@@ -0,0 +1,251 @@
+//----------------------------------------------------------------------------------
+// Microbenchmarks for the simulation, and the baseline comparison behind `make bench`
+//
+// Usage: pong_bench [--filter TEXT] [--min-time SECONDS]
+//        pong_bench --compare BASELINE RESULTS [--tolerance PERCENT]
+//
+// Every result is one line, "BENCH <name> <value> <unit>", with the unit ns/op (lower is
+// better) or fps (higher is better). The game prints render results in the same format
+// with --bench, so both go into one results file. --compare reads the BENCH lines of two
+// files, ignoring everything else, and fails when any result is worse than its baseline
+// by more than the tolerance. Results without a baseline are listed as new
+//
+// Each benchmark runs batches until --min-time has passed and reports the fastest batch,
+// which is the least disturbed by the rest of the machine
+//----------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "pong_sim.h"
+#include "level.h"
+#include "telemetry.h"
+
+static const int BATCH_OPS = 4096;
+static double minTime = 0.25;               // Seconds per benchmark
+static const char *filter = NULL;
+static volatile float sink;                 // Keeps results alive so the work isn't optimized away
+
+typedef void (*BenchFunction)(PongSim *sim, int ops);
+
+static double NowSeconds(void)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void RunBenchmark(const char *name, PongSim *sim, BenchFunction function)
+{
+    if (filter != NULL && strstr(name, filter) == NULL) return;
+
+    function(sim, BATCH_OPS);   // Warm up caches and branch predictors
+    double best = 1e30;
+    double end = NowSeconds() + minTime;
+    do {
+        double start = NowSeconds();
+        function(sim, BATCH_OPS);
+        double elapsed = NowSeconds() - start;
+        if (elapsed < best) best = elapsed;
+    } while (NowSeconds() < end);
+
+    printf("BENCH %-28s %10.1f ns/op\n", name, best * 1e9 / BATCH_OPS);
+    fflush(stdout);
+}
+
+//----------------------------------------------------------------------------------
+// Benchmarks
+//----------------------------------------------------------------------------------
+// AI against AI, restarting whenever a match ends, so the mix of rallies and serves is realistic
+static void StepMatches(PongSim *sim, int ops)
+{
+    for (int i = 0; i < ops; i++) {
+        if (sim->matchOver) StartPongSimMatch(sim, sim->seed + 1);
+        StepPongSim(sim, 0);
+    }
+    sink = sim->ball.x;
+}
+
+static void PredictDirect(PongSim *sim, int ops)
+{
+    Ball ball = sim->ball;
+    float sum = 0;
+    for (int i = 0; i < ops; i++) {
+        ball.y = (float)(COURT_Y + 20 + (i & 255));
+        sum += PredictBallY(&ball, COURT_X + 40, false);
+    }
+    sink = sum;
+}
+
+// A steep, fast ball headed for the far paddle bounces off the walls dozens of times on
+// the way, the worst case for the old reflection loop and a single fold now
+static void PredictWorstCase(PongSim *sim, int ops)
+{
+    Ball ball = sim->ball;
+    ball.x = COURT_X + COURT_WIDTH - 60;
+    ball.speedX = -0.5f;
+    ball.speedY = 45.0f;
+    float sum = 0;
+    for (int i = 0; i < ops; i++) {
+        ball.y = (float)(COURT_Y + 20 + (i & 255));
+        sum += PredictBallY(&ball, COURT_X + 40, true);
+    }
+    sink = sum;
+}
+
+static void Serve(PongSim *sim, int ops)
+{
+    for (int i = 0; i < ops; i++) ServeBall(sim, 0);
+    sink = sim->ball.speedX;
+}
+
+static unsigned char snapshotBuffer[PONG_SIM_SNAPSHOT_MAX];
+
+static void SaveSnapshot(PongSim *sim, int ops)
+{
+    int size = 0;
+    for (int i = 0; i < ops; i++) size += SavePongSimSnapshot(sim, snapshotBuffer);
+    sink = (float)size;
+}
+
+static void LoadSnapshot(PongSim *sim, int ops)
+{
+    SavePongSimSnapshot(sim, snapshotBuffer);
+    for (int i = 0; i < ops; i++) LoadPongSimSnapshot(sim, snapshotBuffer);
+    sink = sim->ball.x;
+}
+
+// One paddle hit pushed, then drained the way the writer thread would, without the file
+static void PushTelemetryEvents(PongSim *sim, int ops)
+{
+    static TelemetryEvent drained[BATCH_OPS];
+    TelemetryEvent event = { TELEMETRY_PADDLE_HIT, SIDE_PLAYER, (uint8_t)sim->difficulty, 0, 0,
+                             sim->ball.x, sim->ball.y, sim->ball.speedX, sim->ball.speedY, 0.25f };
+    for (int i = 0; i < ops; i++) {
+        event.tick = (uint32_t)i;
+        PushTelemetry(&event);
+    }
+    sink = (float)DrainTelemetry(drained, BATCH_OPS);
+}
+
+static void InitBenchSim(PongSim *sim, DifficultyLevel difficulty, int extraBalls)
+{
+    InitPongSim(sim, difficulty, 1);
+    sim->controllers[SIDE_PLAYER] = CONTROLLER_AI;
+    SetPongSimExtraBalls(sim, extraBalls);
+}
+
+static int RunBenchmarks(void)
+{
+    static PongSim sim;
+
+    static const char *stepNames[] = { "sim.step.easy", "sim.step.medium", "sim.step.hard", "sim.step.impossible" };
+    for (int d = EASY; d <= IMPOSSIBLE; d++) {
+        InitBenchSim(&sim, (DifficultyLevel)d, 0);
+        RunBenchmark(stepNames[d], &sim, StepMatches);
+    }
+    InitBenchSim(&sim, HARD, 499);
+    RunBenchmark("sim.step.multiball", &sim, StepMatches);
+    InitBenchSim(&sim, HARD, 0);
+    SetPongSimLevel(&sim, LEVEL_MOSAIC);
+    RunBenchmark("sim.step.mosaic", &sim, StepMatches);
+    InitBenchSim(&sim, HARD, 499);
+    SetPongSimLevel(&sim, LEVEL_MOSAIC);
+    RunBenchmark("sim.step.mosaic.multiball", &sim, StepMatches);
+
+    InitBenchSim(&sim, HARD, 0);
+    RunBenchmark("sim.predict.direct", &sim, PredictDirect);
+    RunBenchmark("sim.predict.worst", &sim, PredictWorstCase);
+    RunBenchmark("sim.serve", &sim, Serve);
+    RunBenchmark("sim.snapshot.save", &sim, SaveSnapshot);
+    RunBenchmark("sim.snapshot.load", &sim, LoadSnapshot);
+    InitBenchSim(&sim, HARD, 499);
+    RunBenchmark("sim.snapshot.save.multiball", &sim, SaveSnapshot);
+
+    InitBenchSim(&sim, HARD, 0);
+    RunBenchmark("telemetry.push", &sim, PushTelemetryEvents);
+    return 0;
+}
+
+//----------------------------------------------------------------------------------
+// Baseline comparison
+//----------------------------------------------------------------------------------
+struct BenchResult {
+    double value;
+    std::string unit;
+};
+
+static bool ReadResults(const char *fileName, std::map<std::string, BenchResult> *results)
+{
+    FILE *file = fopen(fileName, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open %s\n", fileName);
+        return false;
+    }
+    char line[512], name[128], unit[32];
+    double value;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "BENCH %127s %lf %31s", name, &value, unit) == 3) (*results)[name] = (BenchResult){ value, unit };
+    }
+    fclose(file);
+    return true;
+}
+
+static int CompareResults(const char *baselineFile, const char *resultsFile, double tolerance)
+{
+    std::map<std::string, BenchResult> baseline, results;
+    if (!ReadResults(baselineFile, &baseline) || !ReadResults(resultsFile, &results)) return 1;
+
+    int regressions = 0;
+    printf("%-28s %12s %12s %8s\n", "benchmark", "baseline", "current", "change");
+    for (const auto &entry : results) {
+        const BenchResult &current = entry.second;
+        auto base = baseline.find(entry.first);
+        if (base == baseline.end() || base->second.unit != current.unit) {
+            printf("%-28s %12s %12.1f %8s  %s  new\n", entry.first.c_str(), "-", current.value, "-", current.unit.c_str());
+            continue;
+        }
+
+        // Positive change is always worse: slower for ns/op, fewer frames for fps
+        double old = base->second.value;
+        double change = (old > 0) ? 100.0 * (current.value - old) / old : 0.0;
+        if (current.unit == "fps") change = -change;
+        bool regressed = change > tolerance;
+        if (regressed) regressions++;
+        printf("%-28s %12.1f %12.1f %+7.1f%%  %s%s\n", entry.first.c_str(), old, current.value, change,
+               current.unit.c_str(), regressed ? "  REGRESSION" : "");
+    }
+    for (const auto &entry : baseline) {
+        if (results.find(entry.first) == results.end()) printf("%-28s %12.1f %12s %8s  missing\n", entry.first.c_str(), entry.second.value, "-", "");
+    }
+
+    printf("%d regression%s over %.0f%%\n", regressions, (regressions == 1) ? "" : "s", tolerance);
+    return (regressions > 0) ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *baselineFile = NULL, *resultsFile = NULL;
+    double tolerance = 10.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--compare") == 0 && i + 2 < argc) {
+            baselineFile = argv[++i];
+            resultsFile = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minTime = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--filter TEXT] [--min-time SECONDS]\n"
+                            "       %s --compare BASELINE RESULTS [--tolerance PERCENT]\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    if (baselineFile != NULL) return CompareResults(baselineFile, resultsFile, tolerance);
+    return RunBenchmarks();
+}
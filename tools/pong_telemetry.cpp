@@ -0,0 +1,186 @@
+//----------------------------------------------------------------------------------
+// Telemetry report: aggregates the event logs the game writes with --telemetry
+//
+// Usage: pong_telemetry FILE...
+//
+// Pass the rotated files oldest first (telemetry.ptl.4 ... telemetry.ptl.1 telemetry.ptl)
+// so matches that straddle a rotation are followed across it. Per difficulty it reports:
+//   matches played to the end and abandoned, and how many the player won
+//   match length in seconds, from the first event to GAME_OVER
+//   rally length in paddle hits per point, mean, median, 90th percentile and longest
+//   ball speed off the paddle and how often it was clamped to the top speed
+//   where on the paddle the ball was hit, in eight bands from the top end to the bottom
+//----------------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "pong_sim.h"
+#include "telemetry.h"
+
+static const char *difficultyNames[] = { "easy", "medium", "hard", "impossible" };
+static const int DIFFICULTIES = 4;
+static const int HIT_BANDS = 8;
+
+struct DifficultyReport {
+    int completed, abandoned, online, playerWins;
+    double durationSum, durationMin, durationMax;
+    int durations;
+    std::vector<int> rallies;
+    long long paddleHits, clampedHits, wallHits, obstacleHits;
+    double speedSum, speedMax;
+    long long hitBands[2][HIT_BANDS];
+};
+
+static DifficultyReport reports[DIFFICULTIES];
+
+// What the reader knows about the match in progress, -1 when it started before the logs do
+static long long matchStartTick = -1;
+static int rallyHits = -1;
+
+static std::vector<unsigned char> ReadWholeFile(const char *fileName)
+{
+    std::vector<unsigned char> data;
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) return data;
+    unsigned char chunk[65536];
+    size_t count;
+    while ((count = fread(chunk, 1, sizeof(chunk), file)) > 0) data.insert(data.end(), chunk, chunk + count);
+    fclose(file);
+    return data;
+}
+
+static void AddEvent(const TelemetryEvent &event)
+{
+    if (event.difficulty >= DIFFICULTIES) return;
+    DifficultyReport *report = &reports[event.difficulty];
+
+    switch (event.type) {
+        case TELEMETRY_MATCH_START:
+            matchStartTick = event.tick;
+            rallyHits = 0;
+            break;
+        case TELEMETRY_PADDLE_HIT: {
+            if (rallyHits >= 0) rallyHits++;
+            report->paddleHits++;
+            if (event.flags & TELEMETRY_SPEED_CLAMPED) report->clampedHits++;
+            double speed = fabs(event.speedX);
+            report->speedSum += speed;
+            report->speedMax = std::max(report->speedMax, speed);
+            int band = (int)((event.hitPosition + 1.0f) * 0.5f * HIT_BANDS);
+            band = std::min(std::max(band, 0), HIT_BANDS - 1);
+            report->hitBands[event.side & 1][band]++;
+        } break;
+        case TELEMETRY_WALL_HIT:
+            report->wallHits++;
+            break;
+        case TELEMETRY_OBSTACLE_HIT:
+            report->obstacleHits++;
+            break;
+        case TELEMETRY_SCORE:
+            if (rallyHits >= 0) report->rallies.push_back(rallyHits);
+            rallyHits = 0;
+            break;
+        case TELEMETRY_MATCH_END:
+            if (event.flags & TELEMETRY_ABANDONED) report->abandoned++;
+            else {
+                report->completed++;
+                if (event.side == SIDE_PLAYER) report->playerWins++;
+                if (matchStartTick >= 0 && event.tick >= matchStartTick) {
+                    double seconds = (double)(event.tick - matchStartTick) / SIM_TICK_RATE;
+                    if (report->durations == 0 || seconds < report->durationMin) report->durationMin = seconds;
+                    if (report->durations == 0 || seconds > report->durationMax) report->durationMax = seconds;
+                    report->durationSum += seconds;
+                    report->durations++;
+                }
+            }
+            if (event.flags & TELEMETRY_ONLINE) report->online++;
+            matchStartTick = -1;
+            rallyHits = -1;
+            break;
+        default: break;
+    }
+}
+
+static bool ReadLog(const char *fileName, long long *eventCount)
+{
+    std::vector<unsigned char> data = ReadWholeFile(fileName);
+    if (!ReadTelemetryHeader(data.data(), (int)data.size())) {
+        fprintf(stderr, "%s: not a telemetry log, or a different version\n", fileName);
+        return false;
+    }
+
+    // A log cut short by a crash ends in a partial event, which is ignored
+    size_t count = (data.size() - TELEMETRY_HEADER_SIZE) / TELEMETRY_EVENT_SIZE;
+    for (size_t i = 0; i < count; i++) {
+        TelemetryEvent event;
+        DecodeTelemetryEvent(data.data() + TELEMETRY_HEADER_SIZE + i * TELEMETRY_EVENT_SIZE, &event);
+        AddEvent(event);
+    }
+    *eventCount += (long long)count;
+    return true;
+}
+
+static int Percentile(const std::vector<int> &sorted, double fraction)
+{
+    return sorted[(size_t)(fraction * (sorted.size() - 1) + 0.5)];
+}
+
+static void PrintReport(int difficulty)
+{
+    DifficultyReport *report = &reports[difficulty];
+    if (report->completed + report->abandoned == 0 && report->paddleHits == 0) return;
+
+    printf("\n%s\n", difficultyNames[difficulty]);
+    printf("  matches   %d completed, %d abandoned, %d online, player won %d\n",
+           report->completed, report->abandoned, report->online, report->playerWins);
+    if (report->durations > 0) {
+        printf("  length    avg %.1f s, min %.1f s, max %.1f s\n",
+               report->durationSum / report->durations, report->durationMin, report->durationMax);
+    }
+
+    std::vector<int> &rallies = report->rallies;
+    if (!rallies.empty()) {
+        std::sort(rallies.begin(), rallies.end());
+        long long total = 0;
+        for (int hits : rallies) total += hits;
+        printf("  rallies   %d points, avg %.1f hits, p50 %d, p90 %d, longest %d\n", (int)rallies.size(),
+               (double)total / rallies.size(), Percentile(rallies, 0.5), Percentile(rallies, 0.9), rallies.back());
+    }
+
+    if (report->paddleHits > 0) {
+        printf("  hits      %lld paddle, %lld wall, %lld obstacle\n", report->paddleHits, report->wallHits,
+               report->obstacleHits);
+        printf("  speed     avg %.2f, max %.2f px/frame, clamped %.1f%%\n", report->speedSum / report->paddleHits,
+               report->speedMax, 100.0 * report->clampedHits / report->paddleHits);
+        static const char *sideNames[] = { "player", "computer" };
+        for (int side = 0; side < 2; side++) {
+            long long sideHits = 0;
+            for (int band = 0; band < HIT_BANDS; band++) sideHits += report->hitBands[side][band];
+            if (sideHits == 0) continue;
+            printf("  %-9s top", sideNames[side]);
+            for (int band = 0; band < HIT_BANDS; band++) printf(" %5.1f%%", 100.0 * report->hitBands[side][band] / sideHits);
+            printf(" bottom\n");
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: pong_telemetry FILE...   (rotated logs oldest first)\n");
+        return 1;
+    }
+
+    long long eventCount = 0;
+    int files = 0;
+    for (int i = 1; i < argc; i++) {
+        if (ReadLog(argv[i], &eventCount)) files++;
+    }
+    if (files == 0) return 1;
+
+    printf("%lld events in %d file(s)\n", eventCount, files);
+    for (int d = 0; d < DIFFICULTIES; d++) PrintReport(d);
+    return 0;
+}
@@ -0,0 +1,508 @@
+//----------------------------------------------------------------------------------
+// AI tournament and tuning harness: plays AI-vs-AI matches between parameter sets on
+// every core and reports win rates with 95% Wilson confidence intervals, so the tuning
+// table in GetDifficultyParams() can be calibrated from data instead of playtesting
+//
+// Usage: pong_tourney [options] ENTRANT ENTRANT...               round-robin tournament
+//        pong_tourney [options] --sweep KEY=LO:HI:STEPS [--target RATE] CANDIDATE OPPONENT
+//
+// Options: --matches N (per pairing or sweep point, default 1000)
+//          --ball easy|medium|hard|impossible (ball tuning, default medium)
+//          --threads N (default: every core)  --seed S  --max-ticks N
+//
+// An ENTRANT is a preset with optional overrides and an optional label:
+//   hard                            the HARD AI as is
+//   tuned=medium,speed=13.5,deadzone=30
+// AI keys:   accuracy reaction deadzone speed error advanced
+// Ball keys: ballspeed speedup maxspeed (sweep only, they tune the match rather than a side)
+//
+// --sweep plays CANDIDATE against OPPONENT at STEPS evenly spaced values of KEY. With
+// --target it then bisects between the two grid points around that win rate, assuming
+// the win rate is monotonic in KEY, and reports the value that reaches it
+//
+// Every pairing and sweep point uses seeds S..S+N-1, with sides swapped on odd matches.
+// Results don't depend on the thread count, and the printed checksum changes only
+// when simulation or AI behavior changes
+//----------------------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pong_sim.h"
+
+static const char *difficultyNames[] = { "easy", "medium", "hard", "impossible" };
+static const int TASK_MATCHES = 16;         // Matches per queued task, small enough to balance, big enough to amortize the locks
+static const double WILSON_Z = 1.96;        // 95% confidence
+
+struct Entrant {
+    std::string name;
+    AIParams ai;
+};
+
+// A batch of matches between two sides under one ball tuning
+struct Job {
+    AIParams a, b;
+    DifficultyLevel ballLevel;
+    DifficultyParams ball;
+    int matches;
+};
+
+struct JobResult {
+    long long aWins, bWins, unfinished;
+    long long points, hits, ticks;
+};
+
+struct Task {
+    int job;
+    int first, count;
+};
+
+// Each worker pops from the back of its own queue and steals from the front of the others
+struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+static uint64_t baseSeed = 1;
+static long long maxTicks = 10LL * 60 * SIM_TICK_RATE;    // AI pairs can rally forever
+
+//----------------------------------------------------------------------------------
+// Matches and the work-stealing pool
+//----------------------------------------------------------------------------------
+static void PlayMatch(const Job &job, int index, JobResult *result)
+{
+    PongSim sim;
+    InitPongSim(&sim, job.ballLevel, baseSeed + index);
+    sim.params = job.ball;
+    StartPongSimMatch(&sim, baseSeed + index);      // Serve again with the job's ball tuning
+
+    // Swapping sides on odd matches cancels out any advantage of serving or court side
+    bool swapped = (index & 1) != 0;
+    sim.ai[SIDE_PLAYER] = swapped ? job.b : job.a;
+    sim.ai[SIDE_COMPUTER] = swapped ? job.a : job.b;
+    sim.controllers[SIDE_PLAYER] = CONTROLLER_AI;
+    sim.controllers[SIDE_COMPUTER] = CONTROLLER_AI;
+
+    long long ticks = 0;
+    while (!sim.matchOver && ticks < maxTicks) {
+        StepPongSim(&sim, 0);
+        ticks++;
+        for (int i = 0; i < sim.eventCount; i++) {
+            if (sim.events[i].type == SIM_EVENT_PADDLE_HIT) result->hits++;
+            else if (sim.events[i].type == SIM_EVENT_SCORE) result->points++;
+        }
+    }
+
+    result->ticks += ticks;
+    if (!sim.matchOver) result->unfinished++;
+    else if ((sim.playerScore > sim.computerScore) != swapped) result->aWins++;
+    else result->bWins++;
+}
+
+static bool TakeTask(std::vector<std::unique_ptr<WorkerQueue>> &queues, int self, Task *task)
+{
+    {
+        WorkerQueue &own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            *task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // No task spawns another, so once every queue is empty the work is done
+    int count = (int)queues.size();
+    for (int i = 1; i < count; i++) {
+        WorkerQueue &victim = *queues[(self + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            *task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::vector<JobResult> RunJobs(const std::vector<Job> &jobs, int threadCount)
+{
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    for (int i = 0; i < threadCount; i++) queues.emplace_back(new WorkerQueue());
+
+    // Deal tasks round-robin, match lengths vary a lot so stealing evens out the rest
+    int next = 0;
+    for (int job = 0; job < (int)jobs.size(); job++) {
+        for (int first = 0; first < jobs[job].matches; first += TASK_MATCHES) {
+            Task task = { job, first, std::min(TASK_MATCHES, jobs[job].matches - first) };
+            queues[next++ % threadCount]->tasks.push_back(task);
+        }
+    }
+
+    // Each worker adds into its own results, merged once everyone is done
+    std::vector<std::vector<JobResult>> workerResults(threadCount, std::vector<JobResult>(jobs.size(), JobResult()));
+    std::vector<std::thread> workers;
+    for (int w = 0; w < threadCount; w++) {
+        workers.emplace_back([&, w]() {
+            Task task;
+            while (TakeTask(queues, w, &task)) {
+                for (int m = task.first; m < task.first + task.count; m++) PlayMatch(jobs[task.job], m, &workerResults[w][task.job]);
+            }
+        });
+    }
+    for (std::thread &worker : workers) worker.join();
+
+    std::vector<JobResult> results(jobs.size(), JobResult());
+    for (int w = 0; w < threadCount; w++) {
+        for (size_t j = 0; j < jobs.size(); j++) {
+            const JobResult &part = workerResults[w][j];
+            JobResult &total = results[j];
+            total.aWins += part.aWins;
+            total.bWins += part.bWins;
+            total.unfinished += part.unfinished;
+            total.points += part.points;
+            total.hits += part.hits;
+            total.ticks += part.ticks;
+        }
+    }
+    return results;
+}
+
+//----------------------------------------------------------------------------------
+// Statistics and reporting
+//----------------------------------------------------------------------------------
+// Win rate over decided matches and its Wilson score interval, which stays honest near 0 and 1
+static void WinRate(long long wins, long long losses, double *rate, double *low, double *high)
+{
+    double n = (double)(wins + losses);
+    if (n == 0) {
+        *rate = 0.5; *low = 0.0; *high = 1.0;
+        return;
+    }
+    double p = wins / n;
+    double z2 = WILSON_Z * WILSON_Z;
+    double center = (p + z2 / (2 * n)) / (1 + z2 / n);
+    double half = WILSON_Z * sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / (1 + z2 / n);
+    *rate = p;
+    *low = center - half;
+    *high = center + half;
+}
+
+static double AverageRally(const JobResult &result)
+{
+    return (result.points > 0) ? (double)result.hits / result.points : 0.0;
+}
+
+static uint64_t Checksum(const std::vector<JobResult> &results, uint64_t checksum)
+{
+    for (const JobResult &r : results) {
+        uint64_t values[5] = { (uint64_t)r.aWins, (uint64_t)r.bWins, (uint64_t)r.unfinished, (uint64_t)r.hits, (uint64_t)r.ticks };
+        for (int i = 0; i < 5; i++) checksum = (checksum ^ values[i]) * 1099511628211ULL;
+    }
+    return checksum;
+}
+
+//----------------------------------------------------------------------------------
+// Parameter parsing
+//----------------------------------------------------------------------------------
+static bool ParseDifficulty(const char *name, DifficultyLevel *difficulty)
+{
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(name, difficultyNames[i]) == 0) {
+            *difficulty = (DifficultyLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool IsBallKey(const std::string &key)
+{
+    return key == "ballspeed" || key == "speedup" || key == "maxspeed";
+}
+
+// Applies one tuning value, AI keys to ai and ball keys to ball. False for an unknown key
+static bool SetTuningValue(const std::string &key, double value, AIParams *ai, DifficultyParams *ball)
+{
+    if (key == "accuracy") ai->accuracy = (float)value;
+    else if (key == "reaction") ai->reactionSpeed = (float)value;
+    else if (key == "deadzone") ai->deadZone = (float)value;
+    else if (key == "speed") ai->paddleSpeed = (float)value;
+    else if (key == "error") ai->predictionError = (float)value;
+    else if (key == "advanced") ai->advancedPrediction = (value != 0);
+    else if (key == "ballspeed" && ball != NULL) ball->initialSpeed = (float)value;
+    else if (key == "speedup" && ball != NULL) ball->speedIncreaseFactor = -(float)value;     // Stored negated, it also reverses the ball
+    else if (key == "maxspeed" && ball != NULL) ball->maxSpeed = (float)value;
+    else return false;
+    return true;
+}
+
+// "preset" or "label=preset,key=value,..."
+static bool ParseEntrant(const char *text, Entrant *entrant)
+{
+    std::string spec = text;
+    std::string label;
+    size_t comma = spec.find(',');
+    size_t equals = spec.find('=');
+    if (equals != std::string::npos && (comma == std::string::npos || equals < comma)) {
+        label = spec.substr(0, equals);
+        spec = spec.substr(equals + 1);
+    }
+
+    std::vector<std::string> items;
+    for (size_t start = 0;;) {
+        size_t end = spec.find(',', start);
+        items.push_back(spec.substr(start, end - start));
+        if (end == std::string::npos) break;
+        start = end + 1;
+    }
+
+    DifficultyLevel preset;
+    if (!ParseDifficulty(items[0].c_str(), &preset)) {
+        fprintf(stderr, "Unknown preset '%s' in entrant %s\n", items[0].c_str(), text);
+        return false;
+    }
+    entrant->ai = GetDifficultyParams(preset).ai;
+    entrant->name = label.empty() ? spec : label;
+
+    for (size_t i = 1; i < items.size(); i++) {
+        size_t split = items[i].find('=');
+        std::string key = items[i].substr(0, split);
+        if (split == std::string::npos || !SetTuningValue(key, atof(items[i].c_str() + split + 1), &entrant->ai, NULL)) {
+            fprintf(stderr, "Bad setting '%s' in entrant %s\n", items[i].c_str(), text);
+            return false;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------
+// Modes
+//----------------------------------------------------------------------------------
+static void RunTournament(const std::vector<Entrant> &entrants, DifficultyLevel ballLevel, int matches, int threadCount)
+{
+    std::vector<Job> jobs;
+    std::vector<std::pair<int, int>> pairings;
+    for (size_t a = 0; a < entrants.size(); a++) {
+        for (size_t b = a + 1; b < entrants.size(); b++) {
+            jobs.push_back((Job){ entrants[a].ai, entrants[b].ai, ballLevel, GetDifficultyParams(ballLevel), matches });
+            pairings.push_back(std::make_pair((int)a, (int)b));
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<JobResult> results = RunJobs(jobs, threadCount);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (seconds <= 0.0) seconds = 1e-9;
+
+    printf("ball             %s\n", difficultyNames[ballLevel]);
+    printf("entrants         %zu, %zu pairings of %d matches, %d threads\n\n", entrants.size(), jobs.size(), matches, threadCount);
+    printf("%-32s %11s %8s %18s %7s %6s\n", "pairing", "wins", "win rate", "95% CI", "rally", "unfin.");
+
+    std::vector<long long> wins(entrants.size(), 0), losses(entrants.size(), 0);
+    long long totalMatches = 0;
+    for (size_t j = 0; j < jobs.size(); j++) {
+        const JobResult &r = results[j];
+        int a = pairings[j].first, b = pairings[j].second;
+        wins[a] += r.aWins; losses[a] += r.bWins;
+        wins[b] += r.bWins; losses[b] += r.aWins;
+        totalMatches += r.aWins + r.bWins + r.unfinished;
+
+        double rate, low, high;
+        WinRate(r.aWins, r.bWins, &rate, &low, &high);
+        std::string name = entrants[a].name + " vs " + entrants[b].name;
+        std::string score = std::to_string(r.aWins) + "-" + std::to_string(r.bWins);
+        printf("%-32s %11s %7.1f%%    [%5.1f, %5.1f] %7.2f %6lld\n", name.c_str(), score.c_str(),
+               100 * rate, 100 * low, 100 * high, AverageRally(r), r.unfinished);
+    }
+
+    // Standings, best overall win rate first
+    std::vector<int> order(entrants.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = (int)i;
+    std::sort(order.begin(), order.end(), [&](int x, int y) {
+        return wins[x] * (wins[y] + losses[y]) > wins[y] * (wins[x] + losses[x]);
+    });
+    printf("\nstandings\n");
+    for (int i : order) {
+        double rate, low, high;
+        WinRate(wins[i], losses[i], &rate, &low, &high);
+        printf("  %-20s %6.1f%%  [%5.1f, %5.1f]  (%lld-%lld)\n", entrants[i].name.c_str(), 100 * rate, 100 * low, 100 * high, wins[i], losses[i]);
+    }
+
+    printf("\nwall time        %.3f s\n", seconds);
+    printf("matches/sec      %.1f\n", totalMatches / seconds);
+    printf("checksum         %016llx\n", (unsigned long long)Checksum(results, 14695981039346656037ULL));
+}
+
+static Job SweepJob(const Entrant &candidate, const Entrant &opponent, DifficultyLevel ballLevel, const std::string &key, double value, int matches)
+{
+    Job job = { candidate.ai, opponent.ai, ballLevel, GetDifficultyParams(ballLevel), matches };
+    SetTuningValue(key, value, &job.a, &job.ball);
+    return job;
+}
+
+static void PrintSweepRow(const char *label, double value, const JobResult &r)
+{
+    double rate, low, high;
+    WinRate(r.aWins, r.bWins, &rate, &low, &high);
+    printf("%-8s %10.4g %7.1f%%    [%5.1f, %5.1f] %7.2f %6lld\n", label, value, 100 * rate, 100 * low, 100 * high, AverageRally(r), r.unfinished);
+}
+
+static double CandidateRate(const JobResult &r)
+{
+    long long decided = r.aWins + r.bWins;
+    return (decided > 0) ? (double)r.aWins / decided : 0.5;
+}
+
+static int RunSweep(const Entrant &candidate, const Entrant &opponent, DifficultyLevel ballLevel, const std::string &key,
+                    double low, double high, int steps, double target, int searchSteps, int matches, int threadCount)
+{
+    std::vector<Job> jobs;
+    std::vector<double> values;
+    for (int i = 0; i < steps; i++) {
+        double value = (steps > 1) ? low + (high - low) * i / (steps - 1) : low;
+        values.push_back(value);
+        jobs.push_back(SweepJob(candidate, opponent, ballLevel, key, value, matches));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<JobResult> results = RunJobs(jobs, threadCount);
+    uint64_t checksum = Checksum(results, 14695981039346656037ULL);
+    long long totalMatches = (long long)steps * matches;
+
+    printf("ball             %s%s\n", difficultyNames[ballLevel], IsBallKey(key) ? " (swept)" : "");
+    printf("sweep            %s of %s from %g to %g, %d points of %d matches vs %s, %d threads\n\n",
+           key.c_str(), candidate.name.c_str(), low, high, steps, matches, opponent.name.c_str(), threadCount);
+    printf("%-8s %10s %8s %18s %7s %6s\n", "", key.c_str(), "win rate", "95% CI", "rally", "unfin.");
+    for (int i = 0; i < steps; i++) PrintSweepRow("grid", values[i], results[i]);
+
+    if (target >= 0) {
+        // Find neighbouring grid points on either side of the target, then bisect between them
+        int bracket = -1;
+        for (int i = 0; i + 1 < steps && bracket < 0; i++) {
+            double a = CandidateRate(results[i]) - target, b = CandidateRate(results[i + 1]) - target;
+            if (a == 0 || (a < 0) != (b < 0)) bracket = i;
+        }
+        if (bracket < 0) {
+            printf("\ntarget %.1f%% is not reached between %g and %g\n", 100 * target, low, high);
+        } else {
+            double lo = values[bracket], hi = values[bracket + 1];
+            bool rising = CandidateRate(results[bracket + 1]) > CandidateRate(results[bracket]);
+            double best = lo;
+            JobResult bestResult = results[bracket];
+            for (int step = 0; step < searchSteps; step++) {
+                double middle = (lo + hi) / 2;
+                std::vector<Job> probe(1, SweepJob(candidate, opponent, ballLevel, key, middle, matches));
+                JobResult r = RunJobs(probe, threadCount)[0];
+                checksum = Checksum(std::vector<JobResult>(1, r), checksum);
+                totalMatches += matches;
+                PrintSweepRow("search", middle, r);
+
+                if (fabs(CandidateRate(r) - target) <= fabs(CandidateRate(bestResult) - target)) {
+                    best = middle;
+                    bestResult = r;
+                }
+                if ((CandidateRate(r) < target) == rising) lo = middle;
+                else hi = middle;
+            }
+            double rate, ciLow, ciHigh;
+            WinRate(bestResult.aWins, bestResult.bWins, &rate, &ciLow, &ciHigh);
+            printf("\ncalibrated       %s=%g gives %.1f%% [%.1f, %.1f] against %s (target %.1f%%)\n",
+                   key.c_str(), best, 100 * rate, 100 * ciLow, 100 * ciHigh, opponent.name.c_str(), 100 * target);
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (seconds <= 0.0) seconds = 1e-9;
+    printf("\nwall time        %.3f s\n", seconds);
+    printf("matches/sec      %.1f\n", totalMatches / seconds);
+    printf("checksum         %016llx\n", (unsigned long long)checksum);
+    return 0;
+}
+
+static void PrintUsage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--matches N] [--ball easy|medium|hard|impossible] [--threads N] [--seed S] [--max-ticks N] ENTRANT ENTRANT...\n"
+                    "       %s [options] --sweep KEY=LO:HI:STEPS [--target RATE] [--search-steps N] CANDIDATE OPPONENT\n"
+                    "ENTRANT: preset or label=preset,key=value,...  preset: easy medium hard impossible\n"
+                    "AI keys: accuracy reaction deadzone speed error advanced  Ball keys (sweep only): ballspeed speedup maxspeed\n",
+            program, program);
+}
+
+int main(int argc, char *argv[])
+{
+    int matches = 1000;
+    DifficultyLevel ballLevel = MEDIUM;
+    int threadCount = (int)std::thread::hardware_concurrency();
+    if (threadCount < 1) threadCount = 1;
+    const char *sweep = NULL;
+    double target = -1;
+    int searchSteps = 8;
+    std::vector<Entrant> entrants;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--matches") == 0 && i + 1 < argc) {
+            matches = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            baseSeed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            maxTicks = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--sweep") == 0 && i + 1 < argc) {
+            sweep = argv[++i];
+        } else if (strcmp(argv[i], "--target") == 0 && i + 1 < argc) {
+            target = atof(argv[++i]);
+            if (target > 1) target /= 100;      // Accept 30 as well as 0.3
+        } else if (strcmp(argv[i], "--search-steps") == 0 && i + 1 < argc) {
+            searchSteps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ball") == 0 && i + 1 < argc) {
+            if (!ParseDifficulty(argv[++i], &ballLevel)) {
+                fprintf(stderr, "Unknown difficulty: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (argv[i][0] != '-') {
+            Entrant entrant;
+            if (!ParseEntrant(argv[i], &entrant)) return 1;
+            entrants.push_back(entrant);
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (matches < 1) matches = 1;
+
+    if (sweep != NULL) {
+        // KEY=LO:HI:STEPS
+        char key[32];
+        double low, high;
+        int steps;
+        if (sscanf(sweep, "%31[^=]=%lf:%lf:%d", key, &low, &high, &steps) != 4 || steps < 1 || entrants.size() != 2) {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        AIParams ai = entrants[0].ai;
+        DifficultyParams ball = GetDifficultyParams(ballLevel);
+        if (!SetTuningValue(key, low, &ai, &ball)) {
+            fprintf(stderr, "Unknown sweep key: %s\n", key);
+            return 1;
+        }
+        return RunSweep(entrants[0], entrants[1], ballLevel, key, low, high, steps, target, searchSteps, matches, threadCount);
+    }
+
+    if (entrants.size() < 2) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    RunTournament(entrants, ballLevel, matches, threadCount);
+    return 0;
+}
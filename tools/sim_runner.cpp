@@ -0,0 +1,312 @@
+//----------------------------------------------------------------------------------
+// Headless batch runner: plays AI-vs-AI matches with no window or audio device
+// and reports simulation throughput
+//
+// Usage: pong_sim [--matches N] [--difficulty easy|medium|hard|impossible] [--max-ticks N] [--seed S] [--balls N] [--level NAME]
+//        pong_sim --replay FILE
+//        pong_sim --netplay-test [--latency MS] [--jitter MS] [--loss PCT] [--ticks N] [--port P] [--balls N] [--level NAME]
+//
+// Match m is seeded with S + m, so a run is reproducible and the printed
+// checksum changes whenever simulation or AI behavior changes
+// --balls adds N extra multi-ball balls to every match, for timing the SIMD step
+// --level plays on a level's obstacles, see level.h
+// --replay plays a recorded match as fast as possible and prints its outcome
+// --netplay-test runs a host and a joining peer in one process over loopback UDP, with the
+// latency and loss injector on both, random inputs on both paddles and a virtual clock. It
+// passes when both peers and a plain local re-run of the same inputs end in the same state,
+// and both peers hand out the same confirmed events as the re-run produced
+//----------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "level.h"
+#include "netplay.h"
+#include "pong_sim.h"
+#include "replay.h"
+
+static const char *difficultyNames[] = { "easy", "medium", "hard", "impossible" };
+
+static bool ParseDifficulty(const char *name, DifficultyLevel *difficulty)
+{
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(name, difficultyNames[i]) == 0) {
+            *difficulty = (DifficultyLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int RunReplay(const char *fileName)
+{
+    Replay replay;
+    if (!LoadReplay(&replay, fileName)) {
+        fprintf(stderr, "Could not load replay: %s\n", fileName);
+        return 1;
+    }
+
+    PongSim sim;
+    ReplayPlayback playback;
+    long long hits = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    StartReplayPlayback(&playback, &replay, &sim);
+    unsigned int input;
+    while (NextReplayInput(&playback, &sim, &input)) {
+        StepPongSim(&sim, input);
+        for (int i = 0; i < sim.eventCount; i++) {
+            if (sim.events[i].type == SIM_EVENT_PADDLE_HIT) hits++;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (seconds <= 0.0) seconds = 1e-9;
+
+    printf("difficulty       %s\n", difficultyNames[replay.difficulty]);
+    printf("extra balls      %d\n", replay.extraBalls);
+    printf("level            %s\n", GetLevel(replay.level)->name);
+    printf("seed             %llu\n", (unsigned long long)replay.seed);
+    printf("ticks            %d (%.1f s of game time)\n", replay.tickCount, (double)replay.tickCount / SIM_TICK_RATE);
+    printf("score            %d - %d%s\n", sim.playerScore, sim.computerScore, sim.matchOver ? "" : " (unfinished)");
+    printf("paddle hits      %lld\n", hits);
+    printf("wall time        %.3f s (%.0fx real time)\n", seconds, replay.tickCount / (SIM_TICK_RATE * seconds));
+
+    return 0;
+}
+
+// Holds a random direction for a random stretch of ticks, roughly like a person would
+static unsigned int NextBotInput(PongRng *rng, unsigned int *input, int *holdTicks)
+{
+    if (--*holdTicks <= 0) {
+        static const unsigned int choices[3] = { 0, INPUT_PLAYER_UP, INPUT_PLAYER_DOWN };
+        *input = choices[RngRange(rng, 0, 2)];
+        *holdTicks = RngRange(rng, 5, 60);
+    }
+    return *input;
+}
+
+static uint64_t HashSnapshot(const PongSim *sim)
+{
+    static unsigned char buffer[PONG_SIM_SNAPSHOT_MAX];
+    int size = SavePongSimSnapshot(sim, buffer);
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < size; i++) hash = (hash ^ buffer[i]) * 1099511628211ULL;
+    return hash;
+}
+
+static uint64_t HashEvents(uint64_t hash, const SimEvent *events, int eventCount)
+{
+    for (int i = 0; i < eventCount; i++) {
+        uint32_t fields[4] = { (uint32_t)events[i].type, (uint32_t)events[i].side, events[i].tick, (uint32_t)events[i].obstacle };
+        for (uint32_t field : fields) hash = (hash ^ field) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Fold in the confirmed events taken since the last call, as a game would log them
+static uint64_t HashConfirmedEvents(uint64_t hash, NetplaySession *session)
+{
+    const SimEvent *events;
+    int eventCount;
+    while (TakeNetplayConfirmedEvents(session, &events, &eventCount)) hash = HashEvents(hash, events, eventCount);
+    return hash;
+}
+
+static int RunNetplayTest(NetConditions conditions, int ticks, int port, int extraBalls, int level)
+{
+    static NetplaySession host, join;       // Big, each holds its rollback snapshots
+    static PongSim hostSim, joinSim;
+    char address[32];
+    snprintf(address, sizeof(address), "127.0.0.1:%d", port);
+
+    if (!HostNetplay(&host, port, HARD, 12345, extraBalls, level) || !JoinNetplay(&join, address)) {
+        fprintf(stderr, "Could not open loopback sockets on port %d\n", port);
+        return 1;
+    }
+    SetNetplayConditions(&host, conditions);
+    SetNetplayConditions(&join, conditions);
+
+    // Inputs in the tick they take effect, for the local re-run
+    std::vector<unsigned int> hostInputs(ticks + NETPLAY_INPUT_DELAY, 0), joinInputs(ticks + NETPLAY_INPUT_DELAY, 0);
+    PongRng hostBot, joinBot;
+    SeedRng(&hostBot, 1);
+    SeedRng(&joinBot, 2);
+    unsigned int hostInput = 0, joinInput = 0;
+    int hostHold = 0, joinHold = 0;
+    uint64_t hostEvents = 14695981039346656037ULL, joinEvents = 14695981039346656037ULL;
+
+    double now = 1.0;
+    double deadline = now + (double)ticks / SIM_TICK_RATE + 30.0;
+    auto start = std::chrono::steady_clock::now();
+    bool done = false;
+    while (!done && now < deadline) {
+        now += SIM_DT;
+        NetplayState hostState = PollNetplay(&host, &hostSim, now);
+        NetplayState joinState = PollNetplay(&join, &joinSim, now);
+        if (hostState == NETPLAY_DISCONNECTED || joinState == NETPLAY_DISCONNECTED) break;
+
+        if (hostState == NETPLAY_RUNNING && host.tick < ticks) {
+            int tick = host.tick;
+            unsigned int input = NextBotInput(&hostBot, &hostInput, &hostHold);
+            if (AdvanceNetplay(&host, &hostSim, input, now)) hostInputs[tick + NETPLAY_INPUT_DELAY] = input;
+        }
+        if (joinState == NETPLAY_RUNNING && join.tick < ticks) {
+            int tick = join.tick;
+            unsigned int input = NextBotInput(&joinBot, &joinInput, &joinHold);
+            if (AdvanceNetplay(&join, &joinSim, input, now)) joinInputs[tick + NETPLAY_INPUT_DELAY] = input;
+        }
+        hostEvents = HashConfirmedEvents(hostEvents, &host);
+        joinEvents = HashConfirmedEvents(joinEvents, &join);
+
+        done = (host.tick == ticks) && (join.tick == ticks) && IsNetplayConfirmed(&host) && IsNetplayConfirmed(&join);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    PongSim reference;
+    InitPongSim(&reference, HARD, 12345);
+    reference.controllers[SIDE_COMPUTER] = CONTROLLER_HUMAN;
+    SetPongSimLevel(&reference, level);
+    SetPongSimExtraBalls(&reference, extraBalls);
+    uint64_t referenceEvents = 14695981039346656037ULL;
+    for (int tick = 0; tick < ticks; tick++) {
+        StepPongSim(&reference, hostInputs[tick] | (joinInputs[tick] << 2));
+        referenceEvents = HashEvents(referenceEvents, reference.events, reference.eventCount);
+    }
+
+    uint64_t hostHash = HashSnapshot(&hostSim), joinHash = HashSnapshot(&joinSim), referenceHash = HashSnapshot(&reference);
+    bool pass = done && (hostHash == referenceHash) && (joinHash == referenceHash) &&
+                (hostEvents == referenceEvents) && (joinEvents == referenceEvents);
+
+    printf("conditions       %.0f ms latency, %.0f ms jitter, %.1f%% loss each way\n", conditions.latencyMs, conditions.jitterMs, conditions.lossPercent);
+    printf("ticks            %d / %d (%.1f s of game time)\n", host.tick, join.tick, (double)ticks / SIM_TICK_RATE);
+    printf("score            %d - %d\n", reference.playerScore, reference.computerScore);
+    const NetplaySession *sessions[2] = { &host, &join };
+    for (int i = 0; i < 2; i++) {
+        const NetplayStats &stats = sessions[i]->stats;
+        printf("%-16s rtt %.0f ms, %d rollbacks (max %d ticks, %lld re-simulated), %d stalls, %d/%d packets (%d dropped)\n",
+               (i == 0) ? "host" : "join", stats.rttMs, stats.rollbacks, stats.maxRollbackTicks, stats.resimulatedTicks,
+               stats.stalls, stats.packetsSent, stats.packetsReceived, stats.packetsDropped);
+    }
+    printf("state hashes     host %016llx, join %016llx, local %016llx\n",
+           (unsigned long long)hostHash, (unsigned long long)joinHash, (unsigned long long)referenceHash);
+    printf("event hashes     host %016llx, join %016llx, local %016llx\n",
+           (unsigned long long)hostEvents, (unsigned long long)joinEvents, (unsigned long long)referenceEvents);
+    printf("wall time        %.3f s\n", seconds);
+    printf("result           %s\n", pass ? "PASS" : (done ? "DESYNC" : "TIMEOUT"));
+
+    CloseNetplay(&host);
+    CloseNetplay(&join);
+    return pass ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    long long matches = 1000;
+    long long maxTicks = 10LL * 60 * SIM_TICK_RATE;    // Ten minutes of play, AI pairs can rally forever
+    DifficultyLevel difficulty = MEDIUM;
+    uint64_t seed = 1;
+    int extraBalls = 0;
+    int level = LEVEL_CLASSIC;
+    bool netplayTest = false;
+    NetConditions conditions = { 0, 0, 0 };
+    int netplayTicks = 60 * SIM_TICK_RATE;
+    int netplayPort = NETPLAY_DEFAULT_PORT;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--matches") == 0 && i + 1 < argc) {
+            matches = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            maxTicks = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            return RunReplay(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--balls") == 0 && i + 1 < argc) {
+            extraBalls = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--netplay-test") == 0) {
+            netplayTest = true;
+        } else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc) {
+            conditions.latencyMs = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--jitter") == 0 && i + 1 < argc) {
+            conditions.jitterMs = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--loss") == 0 && i + 1 < argc) {
+            conditions.lossPercent = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            netplayTicks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            netplayPort = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--difficulty") == 0 && i + 1 < argc) {
+            if (!ParseDifficulty(argv[++i], &difficulty)) {
+                fprintf(stderr, "Unknown difficulty: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+            level = FindLevel(argv[++i]);
+            if (level < 0) {
+                fprintf(stderr, "Unknown level: %s\n", argv[i]);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [--matches N] [--difficulty easy|medium|hard|impossible] [--max-ticks N] [--seed S] [--balls N] [--level NAME]\n"
+                            "       %s --replay FILE\n"
+                            "       %s --netplay-test [--latency MS] [--jitter MS] [--loss PCT] [--ticks N] [--port P] [--balls N] [--level NAME]\n",
+                    argv[0], argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    if (netplayTest) return RunNetplayTest(conditions, netplayTicks, netplayPort, extraBalls, level);
+
+    long long totalTicks = 0;
+    long long totalHits = 0;
+    long long totalPoints = 0;
+    long long playerWins = 0, computerWins = 0, unfinished = 0;
+    uint64_t checksum = 14695981039346656037ULL;   // FNV-1a over every match result
+
+    PongSim sim;
+    auto start = std::chrono::steady_clock::now();
+
+    for (long long m = 0; m < matches; m++) {
+        InitPongSim(&sim, difficulty, seed + m);
+        sim.controllers[SIDE_PLAYER] = CONTROLLER_AI;
+        SetPongSimLevel(&sim, level);
+        SetPongSimExtraBalls(&sim, extraBalls);
+
+        long long ticks = 0;
+        while (!sim.matchOver && ticks < maxTicks) {
+            StepPongSim(&sim, 0);
+            ticks++;
+
+            for (int i = 0; i < sim.eventCount; i++) {
+                if (sim.events[i].type == SIM_EVENT_PADDLE_HIT) totalHits++;
+                else if (sim.events[i].type == SIM_EVENT_SCORE) totalPoints++;
+            }
+        }
+
+        totalTicks += ticks;
+        uint64_t result[3] = { (uint64_t)sim.playerScore, (uint64_t)sim.computerScore, (uint64_t)ticks };
+        for (int i = 0; i < 3; i++) checksum = (checksum ^ result[i]) * 1099511628211ULL;
+        if (!sim.matchOver) unfinished++;
+        else if (sim.playerScore > sim.computerScore) playerWins++;
+        else computerWins++;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (seconds <= 0.0) seconds = 1e-9;
+
+    printf("difficulty       %s\n", difficultyNames[difficulty]);
+    if (extraBalls > 0) printf("extra balls      %d\n", sim.extraBalls.count);
+    if (level != LEVEL_CLASSIC) printf("level            %s\n", GetLevel(level)->name);
+    printf("matches          %lld (left %lld, right %lld, unfinished %lld)\n", matches, playerWins, computerWins, unfinished);
+    printf("ticks            %lld (%.1f s of game time)\n", totalTicks, (double)totalTicks / SIM_TICK_RATE);
+    printf("avg rally hits   %.2f\n", (totalPoints > 0) ? (double)totalHits / totalPoints : 0.0);
+    printf("wall time        %.3f s\n", seconds);
+    printf("matches/sec      %.1f\n", matches / seconds);
+    printf("ticks/sec        %.0f\n", totalTicks / seconds);
+    printf("checksum         %016llx\n", (unsigned long long)checksum);
+
+    return 0;
+}